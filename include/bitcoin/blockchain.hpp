@@ -23,13 +23,21 @@
 #include <bitcoin/blockchain/define.hpp>
 #include <bitcoin/blockchain/settings.hpp>
 #include <bitcoin/blockchain/version.hpp>
+#include <bitcoin/blockchain/interface/block_cache.hpp>
 #include <bitcoin/blockchain/interface/block_chain.hpp>
+#include <bitcoin/blockchain/interface/compact_block_cache.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
+#include <bitcoin/blockchain/interface/header_index.hpp>
 #include <bitcoin/blockchain/interface/safe_chain.hpp>
 #include <bitcoin/blockchain/pools/block_entry.hpp>
 #include <bitcoin/blockchain/pools/block_organizer.hpp>
+#include <bitcoin/blockchain/pools/block_outpoints.hpp>
 #include <bitcoin/blockchain/pools/block_pool.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
+#include <bitcoin/blockchain/pools/chain_notifier.hpp>
+#include <bitcoin/blockchain/pools/organize_queue.hpp>
+#include <bitcoin/blockchain/pools/orphan_pool.hpp>
+#include <bitcoin/blockchain/pools/short_id_index.hpp>
 #include <bitcoin/blockchain/pools/transaction_entry.hpp>
 #include <bitcoin/blockchain/pools/transaction_organizer.hpp>
 #include <bitcoin/blockchain/pools/transaction_pool.hpp>
@@ -37,6 +45,9 @@
 #include <bitcoin/blockchain/populate/populate_block.hpp>
 #include <bitcoin/blockchain/populate/populate_chain_state.hpp>
 #include <bitcoin/blockchain/populate/populate_transaction.hpp>
+#include <bitcoin/blockchain/validate/assume_valid.hpp>
+#include <bitcoin/blockchain/validate/input_scheduler.hpp>
+#include <bitcoin/blockchain/validate/script_cache.hpp>
 #include <bitcoin/blockchain/validate/validate_block.hpp>
 #include <bitcoin/blockchain/validate/validate_input.hpp>
 #include <bitcoin/blockchain/validate/validate_transaction.hpp>
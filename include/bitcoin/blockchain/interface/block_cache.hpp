@@ -0,0 +1,124 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_BLOCK_CACHE_HPP
+#define LIBBITCOIN_BLOCKCHAIN_BLOCK_CACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// Size bounded LRU cache of recently connected or served chain blocks.
+/// A block is found by hash or by height, its wire form is serialized once
+/// (on first request) and shared immutable between all requesters. Both the
+/// block object (estimated) and the wire form count against the capacity.
+/// Only blocks of the current chain are cached, reorganizations must call
+/// remove_above with the fork height (after the store is written). A reader
+/// filling the cache takes the generation before its store read, so a block
+/// of a chain reorganized in between is not added.
+/// This class is thread safe.
+class BCB_API block_cache
+{
+public:
+    typedef std::shared_ptr<const data_chunk> data_ptr;
+
+    /// The capacity is in bytes, zero disables the cache.
+    explicit block_cache(size_t capacity);
+
+    /// The bytes a cached block object is estimated to hold.
+    static size_t footprint(message::block const& block);
+
+    block_cache(block_cache const&) = delete;
+    block_cache& operator=(block_cache const&) = delete;
+
+    bool enabled() const;
+
+    /// Add a chain block, replacing any block at the same height.
+    void add(block_const_ptr block, size_t height);
+
+    /// Add a block read from the store, ignored if remove_above was called
+    /// since the generation was taken.
+    void add(block_const_ptr block, size_t height, size_t generation);
+
+    /// Remove all blocks above the height, starting a new generation.
+    void remove_above(size_t height);
+
+    /// The current generation, take it before reading a block to add.
+    size_t generation() const;
+
+    /// The block (and its height), nullptr if not cached.
+    block_const_ptr get(hash_digest const& hash, size_t& out_height) const;
+    block_const_ptr get(size_t height) const;
+
+    /// The block, nullptr if not cached, without counting or reordering.
+    block_const_ptr peek(size_t height) const;
+
+    /// The block in wire form (and its height), nullptr if not cached.
+    data_ptr get_data(hash_digest const& hash, size_t& out_height) const;
+    data_ptr get_data(size_t height) const;
+
+    /// Properties.
+    size_t capacity() const;
+    size_t size() const;
+    size_t count() const;
+    size_t hits() const;
+    size_t misses() const;
+
+private:
+    struct entry {
+        block_const_ptr block;
+        size_t height;
+        size_t bytes;
+        data_ptr data;
+    };
+
+    typedef std::list<entry> entries;
+
+    // Call under lock.
+    void insert(block_const_ptr block, size_t height, size_t bytes);
+    void erase(entries::iterator it) const;
+    block_const_ptr touch(entries::iterator it, size_t& out_height) const;
+    data_ptr serialize(block_const_ptr block, size_t height) const;
+
+    // This is thread safe.
+    const size_t capacity_;
+
+    // These are protected by mutex, lookups reorder the entries (front is
+    // the most recently used) and attach wire forms, evicting to make room.
+    mutable entries entries_;
+    mutable std::unordered_map<hash_digest, entries::iterator> by_hash_;
+    mutable std::unordered_map<size_t, entries::iterator> by_height_;
+    mutable size_t size_;
+    size_t generation_;
+    mutable shared_mutex mutex_;
+
+    mutable std::atomic<size_t> hits_;
+    mutable std::atomic<size_t> misses_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
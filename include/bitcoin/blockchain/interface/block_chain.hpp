@@ -27,12 +27,20 @@
 #include <vector>
 #include <bitcoin/database.hpp>
 #include <bitcoin/blockchain/define.hpp>
+#include <bitcoin/blockchain/interface/block_cache.hpp>
+#include <bitcoin/blockchain/interface/compact_block_cache.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
+#include <bitcoin/blockchain/interface/header_index.hpp>
 #include <bitcoin/blockchain/interface/safe_chain.hpp>
 #include <bitcoin/blockchain/pools/block_organizer.hpp>
+#include <bitcoin/blockchain/pools/chain_notifier.hpp>
+#include <bitcoin/blockchain/pools/organize_queue.hpp>
+#include <bitcoin/blockchain/pools/short_id_index.hpp>
 #include <bitcoin/blockchain/pools/transaction_organizer.hpp>
 #include <bitcoin/blockchain/populate/populate_chain_state.hpp>
 #include <bitcoin/blockchain/settings.hpp>
+#include <bitcoin/blockchain/validate/assume_valid.hpp>
+#include <bitcoin/blockchain/validate/script_cache.hpp>
 
 #if defined(BITPRIM_WITH_MEMPOOL)
 #include <bitprim/mining/mempool.hpp>
@@ -96,6 +104,8 @@ public:
     /// Get the output that is referenced by the outpoint in the UTXO Set.
     bool get_utxo(chain::output& out_output, size_t& out_height, uint32_t& out_median_time_past, bool& out_coinbase, chain::output_point const& outpoint, size_t branch_height) const override;
 
+    void get_utxos(output_point_ptr_list const& outpoints, size_t branch_height) const override;
+
     // std::pair<result_code, utxo_pool_t> get_utxo_pool_from(uint32_t from, uint32_t to) const {
     std::pair<bool, database::internal_database::utxo_pool_t> get_utxo_pool_from(uint32_t from, uint32_t to) const override;
 #endif// BITPRIM_DB_NEW
@@ -204,6 +214,12 @@ public:
     /// fetch a block by hash.
     void fetch_block(const hash_digest& hash, bool witness, block_fetch_handler handler) const override;
 
+    /// fetch a block in wire form by height, served from the block cache.
+    void fetch_block_data(size_t height, block_data_fetch_handler handler) const override;
+
+    /// fetch a block in wire form by hash, served from the block cache.
+    void fetch_block_data(const hash_digest& hash, block_data_fetch_handler handler) const override;
+
     /// fetch the set of block hashes indicated by the block locator.
     void fetch_locator_block_hashes(get_blocks_const_ptr locator, const hash_digest& threshold, size_t limit, inventory_fetch_handler handler) const override;
 
@@ -229,6 +245,13 @@ public:
     void for_each_transaction(size_t from, size_t to, bool witness, for_each_tx_handler const& handler) const;
 
     void for_each_transaction_non_coinbase(size_t from, size_t to, bool witness, for_each_tx_handler const& handler) const;
+
+    /// Scan the transactions of blocks [from, to], blocks are read in
+    /// parallel. Returns the first failure, or success (also if cancelled).
+    code scan_transactions(size_t from, size_t to, scan_options const& options, scan_tx_handler const& handler) const override;
+
+    /// fetch transactions by hash, looked up in parallel.
+    void fetch_transactions(const hash_list& hashes, bool require_confirmed, bool witness, transactions_fetch_handler handler) const override;
     
     /// fetch transaction by hash.
     void fetch_transaction(const hash_digest& hash, bool require_confirmed, bool witness, transaction_fetch_handler handler) const override;
@@ -252,6 +275,9 @@ public:
     /// fetch block header by hash.
     void fetch_block_header(const hash_digest& hash, block_header_fetch_handler handler) const override;
 
+    /// fetch the block headers of [from, from + count), looked up in parallel.
+    void fetch_block_headers(size_t from, size_t count, block_headers_fetch_handler handler) const override;
+
     /// fetch height of block by hash.
     void fetch_block_height(const hash_digest& hash, block_height_fetch_handler handler) const override;
     
@@ -333,8 +359,16 @@ public:
 #if defined(BITPRIM_DB_SPENDS) || defined(BITPRIM_DB_NEW_FULL)
     /// fetch the inpoint (spender) of an outpoint.
     void fetch_spend(const chain::output_point& outpoint, spend_fetch_handler handler) const override;
+
+    /// fetch the inpoints (spenders) of outpoints, looked up in parallel.
+    void fetch_spends(const chain::output_point::list& outpoints, spends_fetch_handler handler) const override;
 #endif // BITPRIM_DB_SPENDS
 
+#ifdef BITPRIM_DB_NEW
+    /// fetch the unspent outputs of outpoints, looked up in parallel.
+    void fetch_utxos(const chain::output_point::list& outpoints, utxos_fetch_handler handler) const override;
+#endif // BITPRIM_DB_NEW
+
 #if defined(BITPRIM_DB_HISTORY) || defined(BITPRIM_DB_NEW_FULL)
     /// fetch outputs, values and spends for an address_hash.
     void fetch_history(const short_hash& address_hash, size_t limit, size_t from_height, history_fetch_handler handler) const override;
@@ -399,6 +433,15 @@ public:
     //-----------------------------------------------------------------------------
 
     void transaction_validate(transaction_const_ptr tx, result_handler handler) const override;
+
+    // Block Validation.
+    //-----------------------------------------------------------------------------
+
+    /// Validate a block extending the chain top without organizing it.
+    void validate_proposal(block_const_ptr block, proposal_validation_handler handler) const override;
+
+    /// Link checked headers to the assume valid block.
+    size_t add_assume_valid_headers(const chain::header::list& headers) override;
     
     // Organizers.
     //-------------------------------------------------------------------------
@@ -418,9 +461,22 @@ public:
     /// True if the blockchain is stale based on configured age limit.
     bool is_stale_fast() const override;
 
+    /// True if the block is the assume valid block or a proven ancestor.
+    bool is_assumed_valid(const hash_digest& block_hash) const override;
+
     /// Get a reference to the blockchain configuration settings.
     const settings& chain_settings() const;
 
+    /// Get a reference to the script verification cache (for its counters).
+    const script_cache& script_verification_cache() const;
+
+    /// Get a reference to the recent block cache (for its counters).
+    const block_cache& recent_block_cache() const;
+
+    /// Get a reference to the asynchronous organize front-end (for metrics
+    /// and backpressure).
+    organize_queue& organizer_queue();
+
 
 #ifdef BITPRIM_WITH_KEOKEN    
     virtual void fetch_keoken_history(const short_hash& address_hash, size_t limit,
@@ -465,12 +521,38 @@ private:
     //-------------------------------------------------------------------------
 
     code set_chain_state(chain::chain_state::ptr previous);
+    void batch_lookup(std::vector<size_t> const& order,
+        std::function<void(size_t)> const& lookup) const;
     void handle_transaction(const code& ec, transaction_const_ptr tx,
         result_handler handler) const;
     void handle_block(const code& ec, block_const_ptr block,
         result_handler handler) const;
-    void handle_reorganize(const code& ec, block_const_ptr top,
+    void handle_reorganize(const code& ec, size_t fork_height,
+        block_const_ptr_list_const_ptr incoming_blocks,
+        block_const_ptr_list_const_ptr outgoing_blocks,
+        std::vector<compact_block_ptr> const& compact_blocks,
         result_handler handler);
+    std::vector<bool> pooled_transactions(chain::block const& block) const;
+    std::vector<compact_block_ptr> to_compact_blocks(
+        block_const_ptr_list const& blocks) const;
+
+#if defined(BITPRIM_DB_LEGACY) || defined(BITPRIM_DB_NEW_FULL)
+    typedef std::shared_ptr<const chain::transaction::list> transaction_list_const_ptr;
+
+    code read_transactions(size_t height, bool witness,
+        transaction_list_const_ptr& out_transactions) const;
+#endif
+
+#if defined(BITPRIM_DB_TRANSACTION_UNCONFIRMED) || defined(BITPRIM_DB_NEW_FULL)
+    void index_unconfirmed();
+    bool get_unconfirmed(chain::transaction& out_transaction,
+        hash_digest const& txid) const;
+#endif
+
+#ifdef BITPRIM_DB_NEW
+    bool index_headers(size_t from_height);
+    bool load_header_index();
+#endif // BITPRIM_DB_NEW
 
     // These are thread safe.
     std::atomic<bool> stopped_;
@@ -484,6 +566,13 @@ private:
     const populate_chain_state chain_state_populator_;
     database::data_base database_;
 
+#ifdef BITPRIM_DB_NEW
+    // Mirrors the store header chain, updated on start and reorganization.
+    // Saved on close so that a restart does not rescan the store headers.
+    header_index header_index_;
+    const boost::filesystem::path header_index_file_;
+#endif // BITPRIM_DB_NEW
+
     // This is protected by mutex.
     chain::chain_state::ptr pool_state_;
     mutable shared_mutex pool_state_mutex_;
@@ -493,6 +582,26 @@ private:
     mutable threadpool priority_pool_;
     mutable dispatcher dispatch_;
 
+    // Batch queries run here, so they do not queue behind validation.
+    mutable threadpool query_pool_;
+    mutable dispatcher query_dispatch_;
+
+    script_cache script_cache_;
+    assume_valid assume_valid_;
+
+    // Recent chain blocks for serving peers, filled on connect and on fetch.
+    mutable block_cache block_cache_;
+
+    // Compact forms of the most recent chain blocks, built on connect.
+    mutable compact_block_cache compact_block_cache_;
+
+#if defined(BITPRIM_DB_TRANSACTION_UNCONFIRMED) || defined(BITPRIM_DB_NEW_FULL)
+    // Hashes of the unconfirmed pool for compact block short id matching.
+    short_id_index unconfirmed_short_ids_;
+#endif
+
+    // Organizers queue notifications here, delivered outside of validation.
+    chain_notifier notifier_;
 
 #if defined(BITPRIM_WITH_MEMPOOL)
     mining::mempool mempool_;
@@ -501,6 +610,9 @@ private:
     transaction_organizer transaction_organizer_;
     block_organizer block_organizer_;
 
+    // Network threads enqueue here, the queue pool thread calls the organizers.
+    organize_queue organize_queue_;
+
 
 
 #endif // WITH_BLOCKCHAIN_REQUESTER
@@ -0,0 +1,94 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_COMPACT_BLOCK_CACHE_HPP
+#define LIBBITCOIN_BLOCKCHAIN_COMPACT_BLOCK_CACHE_HPP
+
+#include <cstddef>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// Prebuilt BIP152 compact blocks of the most recent chain blocks.
+/// Blocks are compacted once, when connected, so short ids are not hashed
+/// again for each peer. Cached compact blocks are shared by all requesters
+/// and must not be modified.
+/// This class is thread safe.
+class BCB_API compact_block_cache
+{
+public:
+    /// The capacity is in blocks, zero disables the cache.
+    explicit compact_block_cache(size_t capacity);
+
+    compact_block_cache(compact_block_cache const&) = delete;
+    compact_block_cache& operator=(compact_block_cache const&) = delete;
+
+    /// Compact the block, prefilling the coinbase and each transaction that
+    /// is not flagged as pooled (the peer is not expected to have it).
+    /// An empty pooled list prefills only the coinbase.
+    static compact_block_ptr create(message::block const& block,
+        std::vector<bool> const& pooled, bool witness);
+
+    bool enabled() const;
+
+    /// Add the compact form of a chain block, replacing any at the height.
+    /// Only the highest capacity blocks are kept.
+    void add(compact_block_ptr block, size_t height);
+
+    /// Add the compact form of a block read from the store, ignored if
+    /// remove_above was called since the generation was taken.
+    void add(compact_block_ptr block, size_t height, size_t generation);
+
+    /// Remove all blocks above the height, starting a new generation.
+    void remove_above(size_t height);
+
+    /// The current generation, take it before reading a block to add.
+    size_t generation() const;
+
+    /// The compact block (and its height), nullptr if not cached.
+    compact_block_ptr get(hash_digest const& hash, size_t& out_height) const;
+    compact_block_ptr get(size_t height) const;
+
+    /// Properties.
+    size_t capacity() const;
+    size_t count() const;
+
+private:
+    // Call under lock.
+    void insert(compact_block_ptr block, size_t height);
+    void erase(std::map<size_t, compact_block_ptr>::iterator it);
+
+    // This is thread safe.
+    const size_t capacity_;
+
+    // These are protected by mutex.
+    std::map<size_t, compact_block_ptr> by_height_;
+    std::unordered_map<hash_digest, size_t> heights_;
+    size_t generation_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
@@ -20,6 +20,7 @@
 #define LIBBITCOIN_BLOCKCHAIN_FAST_CHAIN_HPP
 
 #include <cstddef>
+#include <vector>
 #include <bitcoin/database.hpp>
 #include <bitcoin/blockchain/define.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
@@ -37,6 +38,8 @@ public:
     // This avoids conflict with the result_handler in safe_chain.
     typedef handle0 complete_handler;
 
+    typedef std::vector<const chain::output_point*> output_point_ptr_list;
+
     // Readers.
     // ------------------------------------------------------------------------
 
@@ -95,6 +98,11 @@ public:
     /// Get the output that is referenced by the outpoint in the UTXO Set.
     virtual bool get_utxo(chain::output& out_output, size_t& out_height, uint32_t& out_median_time_past, bool& out_coinbase, chain::output_point const& outpoint, size_t branch_height) const = 0;
 
+    /// Get the outputs referenced by the outpoints in the UTXO Set, in key order.
+    /// The validation cache of each outpoint found (at or below branch height)
+    /// is populated, the others are left untouched.
+    virtual void get_utxos(output_point_ptr_list const& outpoints, size_t branch_height) const = 0;
+
     /// Get a UTXO subset from the reorganization pool, [from, to] the specified heights.
     virtual std::pair<bool, database::internal_database::utxo_pool_t> get_utxo_pool_from(uint32_t from, uint32_t to) const = 0;
 
@@ -143,6 +151,9 @@ public:
 
     virtual bool is_stale_fast() const = 0;
 
+    /// True if the block is the assume valid block or a proven ancestor.
+    virtual bool is_assumed_valid(const hash_digest& block_hash) const = 0;
+
 };
 
 } // namespace blockchain
@@ -0,0 +1,119 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_HEADER_INDEX_HPP
+#define LIBBITCOIN_BLOCKCHAIN_HEADER_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// In-memory index of the confirmed header chain, by height and by hash.
+/// The chain state fields are packed in 16 byte records (four per cache
+/// line) so the retarget and median time past windows are a memory walk.
+/// Hashes and cumulative work are held in parallel arrays.
+/// This class is thread safe.
+class BCB_API header_index
+{
+public:
+    struct record {
+        uint32_t bits;
+        uint32_t timestamp;
+        uint32_t version;
+
+        /// Median of the timestamps of the block and up to ten predecessors.
+        uint32_t median_time_past;
+    };
+
+    header_index() = default;
+
+    header_index(header_index const&) = delete;
+    header_index& operator=(header_index const&) = delete;
+
+    /// Remove all entries.
+    void clear();
+
+    /// Reserve space for the given number of headers.
+    void reserve(size_t size);
+
+    /// Append the header at height size().
+    void push(chain::header const& header);
+
+    /// Remove all entries above the height (keeps [0, height]).
+    void truncate(size_t height);
+
+    /// The number of indexed headers, the top height is size() - 1.
+    size_t size() const;
+
+    /// The top height, false if the index is empty.
+    bool top_height(size_t& out_height) const;
+
+    /// Queries, false if the height (or hash) is not indexed.
+    bool get_hash(hash_digest& out_hash, size_t height) const;
+    bool get_height(size_t& out_height, hash_digest const& hash) const;
+    bool get_record(record& out_record, size_t height) const;
+    bool get_bits(uint32_t& out_bits, size_t height) const;
+    bool get_timestamp(uint32_t& out_timestamp, size_t height) const;
+    bool get_version(uint32_t& out_version, size_t height) const;
+    bool get_median_time_past(uint32_t& out_median_time_past, size_t height) const;
+
+    /// Append the hashes of the heights [begin, end) clamped to the top.
+    void get_hashes(hash_list& out_hashes, size_t begin, size_t end) const;
+
+    /// The hashes at the given heights, false if any is not indexed.
+    bool get_locator(hash_list& out_hashes, std::vector<size_t> const& heights) const;
+
+    /// The cumulative proof of work from genesis through the height.
+    bool get_work(uint256_t& out_work, size_t height) const;
+
+    /// The proof of work of the heights [from_height, top], zero if empty.
+    uint256_t get_work_above(size_t from_height) const;
+
+    /// Write the hashes and records to a snapshot file.
+    bool save(boost::filesystem::path const& file) const;
+
+    /// Replace the index with a snapshot file, the work is recomputed.
+    /// The snapshot may be stale, the caller verifies it against the store.
+    bool load(boost::filesystem::path const& file);
+
+private:
+    static size_t const median_time_past_interval = 11;
+    static uint32_t const snapshot_magic = 0x78646968;
+    static uint32_t const snapshot_version = 1;
+
+    uint32_t median_time_past(uint32_t timestamp) const;
+
+    // These are protected by mutex.
+    std::vector<record> records_;
+    std::vector<hash_digest> hashes_;
+    std::vector<uint256_t> work_;
+    std::unordered_map<hash_digest, uint32_t> heights_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
@@ -19,6 +19,7 @@
 #ifndef LIBBITCOIN_BLOCKCHAIN_SAFE_CHAIN_HPP
 #define LIBBITCOIN_BLOCKCHAIN_SAFE_CHAIN_HPP
 
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
@@ -61,10 +62,54 @@ public:
 #endif
     typedef handle1<std::vector<hash_digest>> confirmed_transactions_fetch_handler;
 
+    /// Batch results are in request order, missing keys have a null
+    /// transaction, an invalid header, a null hash spend or output.
+    /// Block headers are returned up to the chain top only.
+    struct transaction_lookup {
+        transaction_const_ptr transaction;
+        size_t position;
+        size_t height;
+    };
+
+    struct utxo_lookup {
+        chain::output output;
+        size_t height;
+        uint32_t median_time_past;
+        bool coinbase;
+    };
+
+    typedef handle1<std::vector<transaction_lookup>> transactions_fetch_handler;
+    typedef handle1<chain::header::list> block_headers_fetch_handler;
+    typedef handle1<chain::input_point::list> spends_fetch_handler;
+    typedef handle1<std::vector<utxo_lookup>> utxos_fetch_handler;
+
+    /// Outcome of a simulated block validation, durations of stages not run
+    /// are zero. The code passed with it is that of the failed stage.
+    struct proposal_validation {
+        enum class stages { check, accept, connect };
+
+        stages stage;
+        size_t height;
+
+        // The chain top moved while validating, the result may be stale.
+        bool chain_changed;
+
+        std::chrono::microseconds check;
+        std::chrono::microseconds accept;
+        std::chrono::microseconds connect;
+    };
+
+    typedef handle1<proposal_validation> proposal_validation_handler;
+
     // Smart pointer parameters must not be passed by reference.
     typedef std::function<void(const code&, block_const_ptr, size_t)>
         block_fetch_handler;
 
+    /// The block in wire form, shared and immutable.
+    typedef std::shared_ptr<const data_chunk> block_data_ptr;
+    typedef std::function<void(const code&, block_data_ptr, size_t)>
+        block_data_fetch_handler;
+
     typedef std::function<void(const code&, header_const_ptr, size_t,  const std::shared_ptr<hash_list>, uint64_t)>
         block_header_txs_size_fetch_handler;
 
@@ -99,6 +144,31 @@ public:
 
     using for_each_tx_handler = std::function<void(code const&, size_t, chain::transaction const&)>;
 
+    /// Scanned transaction (height, position in block), false cancels.
+    using scan_tx_handler = std::function<bool(size_t, size_t, transaction_const_ptr)>;
+
+    struct scan_options {
+        /// Include witness data in the transactions (ignored without segwit).
+        bool witness = false;
+
+        /// Include the coinbase transaction of each block.
+        bool coinbase = true;
+
+        /// Deliver in chain order on the calling thread, otherwise deliver
+        /// concurrently from the worker threads (the handler must be safe).
+        bool ordered = true;
+
+        /// Transactions share (and keep alive) the memory of their block,
+        /// otherwise each transaction is an independent copy.
+        bool borrowed = true;
+
+        /// Number of reading threads, zero for one per core.
+        size_t threads = 0;
+
+        /// Blocks read ahead of ordered delivery (at least one per thread).
+        size_t prefetch = 64;
+    };
+
     using mempool_mini_hash_map = std::unordered_map<mini_hash, chain::transaction>;
 
     // Startup and shutdown.
@@ -116,6 +186,10 @@ public:
 
     virtual void fetch_block(const hash_digest& hash, bool witness, block_fetch_handler handler) const = 0;
 
+    virtual void fetch_block_data(size_t height, block_data_fetch_handler handler) const = 0;
+
+    virtual void fetch_block_data(const hash_digest& hash, block_data_fetch_handler handler) const = 0;
+
     virtual void fetch_locator_block_hashes(get_blocks_const_ptr locator, const hash_digest& threshold, size_t limit, inventory_fetch_handler handler) const = 0;
 
 #if defined(BITPRIM_DB_LEGACY) || defined(BITPRIM_DB_NEW_BLOCKS) || defined(BITPRIM_DB_NEW_FULL)
@@ -141,6 +215,10 @@ public:
 
     virtual void for_each_transaction_non_coinbase(size_t from, size_t to, bool witness, for_each_tx_handler const& handler) const = 0;
 
+    virtual code scan_transactions(size_t from, size_t to, scan_options const& options, scan_tx_handler const& handler) const = 0;
+
+    virtual void fetch_transactions(const hash_list& hashes, bool require_confirmed, bool witness, transactions_fetch_handler handler) const = 0;
+
 #endif 
 
 
@@ -154,6 +232,8 @@ public:
 
     virtual void fetch_block_header(const hash_digest& hash, block_header_fetch_handler handler) const = 0;
 
+    virtual void fetch_block_headers(size_t from, size_t count, block_headers_fetch_handler handler) const = 0;
+
     virtual bool get_block_hash(hash_digest& out_hash, size_t height) const = 0;
 
     virtual void fetch_block_height(const hash_digest& hash, block_height_fetch_handler handler) const = 0;
@@ -165,8 +245,14 @@ public:
 
 #if defined(BITPRIM_DB_SPENDS) || defined(BITPRIM_DB_NEW_FULL)
     virtual void fetch_spend(const chain::output_point& outpoint, spend_fetch_handler handler) const = 0;
+
+    virtual void fetch_spends(const chain::output_point::list& outpoints, spends_fetch_handler handler) const = 0;
 #endif 
 
+#ifdef BITPRIM_DB_NEW
+    virtual void fetch_utxos(const chain::output_point::list& outpoints, utxos_fetch_handler handler) const = 0;
+#endif // BITPRIM_DB_NEW
+
 #if defined(BITPRIM_DB_HISTORY) || defined(BITPRIM_DB_NEW_FULL)
     virtual void fetch_history(const short_hash& address_hash, size_t limit, size_t from_height, history_fetch_handler handler) const = 0;
     virtual void fetch_confirmed_transactions(const short_hash& address_hash, size_t limit, size_t from_height, confirmed_transactions_fetch_handler handler) const = 0;
@@ -217,6 +303,19 @@ public:
 
     virtual void transaction_validate(transaction_const_ptr tx, result_handler handler) const = 0;
 
+    // Block Validation.
+    //-----------------------------------------------------------------------------
+
+    /// Validate a block extending the chain top without organizing it.
+    virtual void validate_proposal(block_const_ptr block, proposal_validation_handler handler) const = 0;
+
+    /// Link checked headers to the assume valid block, returns the number of
+    /// blocks newly proven to be its ancestors (scripts not verified).
+    /// Blocks arrive in height order, so the organizer cannot prove them, the
+    /// node must feed the headers (from header sync) ahead of their blocks.
+    /// Until it does, every script is verified.
+    virtual size_t add_assume_valid_headers(const chain::header::list& headers) = 0;
+
     // Organizers.
     //-------------------------------------------------------------------------
 
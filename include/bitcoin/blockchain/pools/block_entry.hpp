@@ -24,6 +24,7 @@
 #include <boost/functional/hash_fwd.hpp>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/define.hpp>
+#include <bitcoin/blockchain/pools/block_outpoints.hpp>
 
 namespace libbitcoin {
 namespace blockchain {
@@ -39,12 +40,21 @@ public:
     /// Never store an invalid block in the pool.
     block_entry(block_const_ptr block);
 
+    /// Construct an entry for the pool with the outpoints of the block.
+    block_entry(block_const_ptr block, block_outpoints::const_ptr outpoints);
+
     /// Use this construction only as a search key.
     block_entry(const hash_digest& hash);
 
     /// The block that the entry contains.
     block_const_ptr block() const;
 
+    /// The created outputs and spent prevouts of the block (shared).
+    block_outpoints::const_ptr outpoints() const;
+
+    /// The proof of work of the block, computed once when pooled.
+    const uint256_t& proof() const;
+
     /// The hash table entry identity.
     const hash_digest& hash() const;
 
@@ -67,6 +77,8 @@ private:
     // These are non-const to allow for default copy construction.
     hash_digest hash_;
     block_const_ptr block_;
+    block_outpoints::const_ptr outpoints_;
+    uint256_t proof_;
 
     // TODO: could save some bytes here by holding the pointer in place of the
     // hash. This would allow navigation to the hash saving 24 bytes per child.
@@ -29,7 +29,10 @@
 #include <bitcoin/blockchain/interface/safe_chain.hpp>
 #include <bitcoin/blockchain/pools/block_pool.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
+#include <bitcoin/blockchain/pools/chain_notifier.hpp>
+#include <bitcoin/blockchain/pools/orphan_pool.hpp>
 #include <bitcoin/blockchain/settings.hpp>
+#include <bitcoin/blockchain/validate/script_cache.hpp>
 #include <bitcoin/blockchain/validate/validate_block.hpp>
 
 namespace libbitcoin {
@@ -44,18 +47,35 @@ public:
     typedef std::shared_ptr<block_organizer> ptr;
     typedef safe_chain::reorganize_handler reorganize_handler;
     typedef resubscriber<code, size_t, block_const_ptr_list_const_ptr, block_const_ptr_list_const_ptr> reorganize_subscriber;
+    typedef safe_chain::proposal_validation proposal_validation;
+    typedef safe_chain::proposal_validation_handler proposal_validation_handler;
 
     /// Construct an instance.
 #if defined(BITPRIM_WITH_MEMPOOL)
-    block_organizer(prioritized_mutex& mutex, dispatcher& dispatch, threadpool& thread_pool, fast_chain& chain, const settings& settings, bool relay_transactions, mining::mempool& mp);
+    block_organizer(prioritized_mutex& mutex, dispatcher& dispatch, chain_notifier& notifier, fast_chain& chain, const settings& settings, script_cache& cache, bool relay_transactions, mining::mempool& mp);
 #else
-    block_organizer(prioritized_mutex& mutex, dispatcher& dispatch, threadpool& thread_pool, fast_chain& chain, const settings& settings, bool relay_transactions);
+    block_organizer(prioritized_mutex& mutex, dispatcher& dispatch, chain_notifier& notifier, fast_chain& chain, const settings& settings, script_cache& cache, bool relay_transactions);
 #endif
 
     bool start();
     bool stop();
 
     void organize(block_const_ptr block, result_handler handler);
+
+    /// Checks that are independent of chain state. These may run ahead of
+    /// organization and concurrently with it.
+    void check(block_const_ptr block, result_handler handler) const;
+
+    /// Organize a block that passed check, skipping that stage. Acceptance
+    /// (prevout population), connection (scripts) and the store write still
+    /// run one block at a time in the critical section, as the prevouts of a
+    /// block are read from the store its parent is being written to.
+    void organize_checked(block_const_ptr block, result_handler handler);
+
+    /// Validate a block extending the chain top without organizing it.
+    /// This does not enter the critical section, so it runs concurrently
+    /// with organization and other proposals. The block must not be shared.
+    void validate_proposal(block_const_ptr block, proposal_validation_handler handler) const;
     void subscribe(reorganize_handler&& handler);
     void unsubscribe();
 
@@ -69,6 +89,19 @@ private:
     // Utility.
     bool set_branch_height(branch::ptr branch);
 
+    // Organize sub-sequence.
+    void organize(block_const_ptr block, bool checked, result_handler handler);
+    code organize_critical(block_const_ptr block, bool checked);
+    void organize_orphans(hash_digest const& parent);
+
+    // Proposal sub-sequence.
+    struct proposal;
+    typedef std::shared_ptr<proposal> proposal_ptr;
+    void proposal_handle_check(const code& ec, proposal_ptr proposal) const;
+    void proposal_handle_accept(const code& ec, proposal_ptr proposal) const;
+    void proposal_handle_connect(const code& ec, proposal_ptr proposal) const;
+    void proposal_complete(const code& ec, proposal_ptr proposal) const;
+
     // Verify sub-sequence.
     void handle_check(const code& ec, block_const_ptr block, result_handler handler);
     void handle_accept(const code& ec, branch::ptr branch, result_handler handler);
@@ -101,9 +134,13 @@ private:
     std::atomic<bool> stopped_;
     std::promise<code> resume_;
     dispatcher& dispatch_;
+    const settings& settings_;
+    script_cache& script_cache_;
+    const bool relay_transactions_;
     block_pool block_pool_;
+    orphan_pool orphan_pool_;
     validate_block validator_;
-    reorganize_subscriber::ptr subscriber_;
+    chain_notifier& notifier_;
 
 #if defined(BITPRIM_WITH_MEMPOOL)
     mining::mempool& mempool_;
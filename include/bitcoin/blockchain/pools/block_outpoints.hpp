@@ -0,0 +1,69 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_BLOCK_OUTPOINTS_HPP
+#define LIBBITCOIN_BLOCKCHAIN_BLOCK_OUTPOINTS_HPP
+
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+using local_utxo_t = std::unordered_map<chain::point, chain::output const*>;
+using local_spent_t = std::unordered_set<chain::point>;
+
+/// The outputs created and the prevouts spent by a single block.
+/// Built once when the block enters a branch or the block pool, then shared
+/// by reference between every branch that contains the block.
+/// This class is thread safe (immutable).
+class BCB_API block_outpoints
+{
+public:
+    typedef std::shared_ptr<const block_outpoints> const_ptr;
+
+    explicit block_outpoints(block_const_ptr block);
+
+    block_outpoints(block_outpoints const&) = delete;
+    block_outpoints& operator=(block_outpoints const&) = delete;
+
+    /// The indexed block, the created outputs point into it.
+    block_const_ptr block() const;
+
+    /// The outputs of all transactions of the block, including the coinbase.
+    local_utxo_t const& created() const;
+
+    /// The prevouts of all non-coinbase inputs of the block.
+    local_spent_t const& spent() const;
+
+    /// True if a non-coinbase input of the block spends the outpoint.
+    bool spends(chain::output_point const& outpoint) const;
+
+private:
+    block_const_ptr const block_;
+    local_utxo_t const created_;
+    local_spent_t const spent_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
@@ -46,6 +46,10 @@ public:
     /// Add newly-validated block (work insufficient to reorganize).
     void add(block_const_ptr valid_block);
 
+    /// Add newly-validated block with its already indexed outpoints.
+    void add(block_const_ptr valid_block,
+        block_outpoints::const_ptr outpoints);
+
     /// Add root path of reorganized blocks (no branches).
     void add(block_const_ptr_list_const_ptr valid_blocks);
 
@@ -71,7 +75,9 @@ protected:
 
     void prune(const hash_list& hashes, size_t minimum_height);
     bool exists(block_const_ptr candidate_block) const;
-    block_const_ptr parent(block_const_ptr block) const;
+    block_const_ptr parent(block_const_ptr block,
+        block_outpoints::const_ptr& out_outpoints,
+        uint256_t& out_proof) const;
     ////void log_content() const;
 
     // This is thread safe.
@@ -25,12 +25,13 @@
 #include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/define.hpp>
+#include <bitcoin/blockchain/pools/block_outpoints.hpp>
 
 namespace libbitcoin {
 namespace blockchain {
 
-using local_utxo_t = std::unordered_map<chain::point, chain::output const*>;
-using local_utxo_set_t = std::vector<local_utxo_t>;
+/// The created outputs of each block of a branch, composed by reference.
+using local_utxo_set_t = std::vector<std::shared_ptr<local_utxo_t const>>;
 
 /// This class is not thread safe.
 class BCB_API branch {
@@ -45,14 +46,27 @@ public:
     void set_height(size_t height);
 
     /// Push the block onto the branch, true if successfully chains to parent.
+    /// The outpoints of the block are indexed here.
     bool push_front(block_const_ptr block);
 
+    /// Push the block onto the branch with its already indexed outpoints.
+    bool push_front(block_const_ptr block, block_outpoints::const_ptr outpoints);
+
+    /// Push the block onto the branch with its outpoints and its proof.
+    bool push_front(block_const_ptr block, block_outpoints::const_ptr outpoints, uint256_t const& proof);
+
     /// The top block of the branch, if it exists.
     block_const_ptr top() const;
 
     /// The top block of the branch, if it exists.
     size_t top_height() const;
 
+    /// The outpoints index of the top block of the branch, if it exists.
+    block_outpoints::const_ptr top_outpoints() const;
+
+    /// The outpoints index of each block, parallel to blocks().
+    std::vector<block_outpoints::const_ptr> const& outpoints() const;
+
     /////// Populate unspent duplicate state in the context of the branch.
     ////void populate_duplicate(const chain::transaction& tx) const;
 
@@ -61,7 +75,7 @@ public:
 
     /// Populate prevout validation output state in the context of the branch.
     void populate_prevout(chain::output_point const& outpoint) const;
-    void populate_prevout(chain::output_point const& outpoint, std::vector<std::unordered_map<chain::point, chain::output const*>> const& branch_utxo) const;
+    void populate_prevout(chain::output_point const& outpoint, local_utxo_set_t const& branch_utxo) const;
 
     /// The member block pointer list.
     block_const_ptr_list_const_ptr blocks() const;
@@ -72,7 +86,7 @@ public:
     /// The number of blocks in the branch.
     size_t size() const;
 
-    /// Summarize the work of the branch.
+    /// Summarize the work of the branch (accumulated as blocks are pushed).
     uint256_t work() const;
 
     /// The hash of the parent of this branch (branch point).
@@ -106,6 +120,12 @@ private:
 
     /// The chain of blocks in the branch.
     block_const_ptr_list_ptr blocks_;
+
+    /// The per block indexes, shared with the block pool.
+    std::vector<block_outpoints::const_ptr> outpoints_;
+
+    /// The sum of the proofs of the blocks in the branch.
+    uint256_t work_;
 };
 
 local_utxo_t create_local_utxo_set(chain::block const& block);
@@ -0,0 +1,137 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_CHAIN_NOTIFIER_HPP
+#define LIBBITCOIN_BLOCKCHAIN_CHAIN_NOTIFIER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+#include <bitcoin/blockchain/interface/safe_chain.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// Delivers reorganization and transaction notifications off the organizer
+/// critical sections. Each subscriber has a bounded queue drained in order by
+/// one pool task at a time, so a slow subscriber delays only itself.
+/// Consecutive reorganizations pending for a subscriber are coalesced into
+/// one. Transactions are collected for a time window and queued as a batch.
+/// A full queue drops its oldest notification (the drop is counted). A
+/// coalesced reorganization is bounded by the queue limit in incoming blocks,
+/// beyond it the queue is dropped and the subscriber is sent operation_failed
+/// and unsubscribed, so it resyncs from the chain.
+/// This class is thread safe.
+class BCB_API chain_notifier
+{
+public:
+    typedef safe_chain::reorganize_handler reorganize_handler;
+    typedef safe_chain::transaction_handler transaction_handler;
+
+    /// A zero window queues each transaction as it is notified.
+    chain_notifier(threadpool& pool, size_t queue_limit,
+        std::chrono::milliseconds transaction_window);
+
+    chain_notifier(chain_notifier const&) = delete;
+    chain_notifier& operator=(chain_notifier const&) = delete;
+
+    ~chain_notifier();
+
+    bool start();
+
+    /// Discard pending notifications and send service_stopped to all
+    /// subscribers, later subscribers receive it on subscription.
+    bool stop();
+
+    void subscribe_blockchain(reorganize_handler&& handler);
+    void subscribe_transaction(transaction_handler&& handler);
+
+    /// Send null data success notification to all subscribers.
+    void unsubscribe_blockchain();
+    void unsubscribe_transaction();
+
+    void notify(size_t fork_height, block_const_ptr_list_const_ptr incoming,
+        block_const_ptr_list_const_ptr outgoing);
+    void notify(transaction_const_ptr tx);
+
+    /// Properties.
+    size_t queue_limit() const;
+    size_t dropped_reorganizations() const;
+    size_t dropped_transactions() const;
+
+    struct reorganization {
+        code ec;
+        size_t fork_height;
+        block_const_ptr_list_const_ptr incoming;
+        block_const_ptr_list_const_ptr outgoing;
+    };
+
+    struct transaction {
+        code ec;
+        transaction_const_ptr tx;
+    };
+
+    /// Merge next into pending if they are consecutive reorganizations,
+    /// the result is the reorganization from before pending to after next.
+    static bool coalesce(reorganization& pending, const reorganization& next);
+
+private:
+    template <typename Event>
+    class subscription;
+
+    typedef std::shared_ptr<subscription<reorganization>> block_subscription_ptr;
+    typedef std::shared_ptr<subscription<transaction>> transaction_subscription_ptr;
+
+    // The window timer cannot be canceled, so it reaches the notifier
+    // through this, which is cleared on destruct.
+    struct owner {
+        chain_notifier* notifier;
+        std::mutex mutex;
+    };
+
+    void flush();
+    void queue(const std::vector<transaction>& batch);
+
+    // These are thread safe.
+    dispatcher dispatch_;
+    const size_t queue_limit_;
+    const std::chrono::milliseconds window_;
+    std::atomic<size_t> dropped_reorganizations_;
+    std::atomic<size_t> dropped_transactions_;
+
+    // These are protected by mutex.
+    bool stopped_;
+    std::vector<block_subscription_ptr> block_subscriptions_;
+    std::vector<transaction_subscription_ptr> transaction_subscriptions_;
+    std::vector<transaction> pending_;
+    bool window_scheduled_;
+    mutable std::mutex mutex_;
+
+    // This is thread safe.
+    const std::shared_ptr<owner> owner_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
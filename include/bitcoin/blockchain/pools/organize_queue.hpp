@@ -0,0 +1,169 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_ORGANIZE_QUEUE_HPP
+#define LIBBITCOIN_BLOCKCHAIN_ORGANIZE_QUEUE_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// Asynchronous front-end of the block and transaction organizers.
+/// Producers (network threads) enqueue and return, a task on the queue's own
+/// single thread pool organizes one item at a time, blocks before
+/// transactions, and invokes the completion handler. Each queue is bounded,
+/// a producer that finds it full waits for room (nothing is dropped) and the
+/// backpressure handler is raised while either queue is full (cleared when
+/// both are half empty). A zero capacity organizes that kind on the caller
+/// thread, as before. If a block check function is given, each block is
+/// checked as it is queued (concurrently with the organization of the ones
+/// before it) and the organize function receives only blocks that passed.
+/// Only the context free check runs ahead, organization is not pipelined.
+/// This class is thread safe.
+class BCB_API organize_queue
+{
+public:
+    typedef handle0 result_handler;
+    typedef std::function<void(block_const_ptr, result_handler)> block_function;
+    typedef std::function<void(transaction_const_ptr, result_handler)> transaction_function;
+    typedef std::function<void(bool saturated)> backpressure_handler;
+    typedef std::chrono::microseconds duration;
+
+    struct metrics {
+        /// Current and maximum queue depth.
+        size_t queued_blocks;
+        size_t queued_transactions;
+        size_t peak_blocks;
+        size_t peak_transactions;
+
+        /// Completed items and producers that waited for room.
+        size_t organized_blocks;
+        size_t organized_transactions;
+        size_t throttled_blocks;
+        size_t throttled_transactions;
+
+        /// Time spent queued and organizing, total and maximum.
+        duration block_wait;
+        duration block_wait_maximum;
+        duration block_organize;
+        duration transaction_wait;
+        duration transaction_wait_maximum;
+        duration transaction_organize;
+
+        /// Age of the oldest queued item, how far organization lags arrival.
+        duration block_lag;
+        duration transaction_lag;
+    };
+
+    organize_queue(size_t block_capacity, size_t transaction_capacity,
+        block_function check_block, block_function organize_block,
+        transaction_function organize_transaction);
+
+    organize_queue(organize_queue const&) = delete;
+    organize_queue& operator=(organize_queue const&) = delete;
+
+    /// Stops and joins the organizer pool.
+    ~organize_queue();
+
+    bool start();
+
+    /// Complete queued and waiting items with error::service_stopped, the
+    /// item being organized (if any) completes first. Not restartable.
+    bool stop();
+
+    /// Returns once queued, or once organized for a zero capacity.
+    void organize(block_const_ptr block, result_handler handler);
+    void organize(transaction_const_ptr tx, result_handler handler);
+
+    /// Invoked on saturation changes outside of the queue lock, in order.
+    /// The handler may read the queue properties but must not organize.
+    void set_backpressure_handler(backpressure_handler handler);
+
+    /// Properties.
+    bool saturated() const;
+    size_t block_capacity() const;
+    size_t transaction_capacity() const;
+    metrics get_metrics() const;
+
+private:
+    typedef std::chrono::steady_clock clock;
+
+    template <typename Message>
+    struct item {
+        Message message;
+        result_handler handler;
+        clock::time_point queued;
+
+        // Result of the check started on arrival, not valid if none.
+        std::shared_future<code> checked;
+    };
+
+    typedef item<block_const_ptr> block_item;
+    typedef item<transaction_const_ptr> transaction_item;
+
+    template <typename Message>
+    void enqueue(std::deque<item<Message>>& queue, size_t capacity,
+        size_t& peak, size_t& throttled, item<Message>&& queued);
+
+    std::shared_future<code> check(block_const_ptr block) const;
+
+    void drain();
+    void organize_next(std::unique_lock<std::mutex>& lock);
+    void signal_backpressure();
+
+    // Call under lock, true if the saturation changed.
+    bool update_saturation();
+
+    // These are thread safe.
+    const size_t block_capacity_;
+    const size_t transaction_capacity_;
+    const block_function check_block_;
+    const block_function organize_block_;
+    const transaction_function organize_transaction_;
+    threadpool pool_;
+    dispatcher dispatch_;
+
+    // These are protected by mutex.
+    bool stopped_;
+    bool draining_;
+    bool saturated_;
+    std::deque<block_item> blocks_;
+    std::deque<transaction_item> transactions_;
+    backpressure_handler backpressure_;
+    metrics metrics_;
+    mutable std::mutex mutex_;
+    std::condition_variable room_;
+
+    // This is protected by signal mutex, the last saturation signaled.
+    bool signaled_;
+    std::mutex signal_mutex_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,97 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_ORPHAN_POOL_HPP
+#define LIBBITCOIN_BLOCKCHAIN_ORPHAN_POOL_HPP
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// Bounded pool of checked blocks whose parent is not yet known, indexed by
+/// the previous block hash so that the children of a newly organized block
+/// are found directly. The oldest orphans are evicted when the pool exceeds
+/// its size (serialized bytes) or count.
+/// This class is thread safe.
+class BCB_API orphan_pool
+{
+public:
+    /// A zero size or count disables the pool.
+    orphan_pool(size_t maximum_size, size_t maximum_count);
+
+    orphan_pool(orphan_pool const&) = delete;
+    orphan_pool& operator=(orphan_pool const&) = delete;
+
+    bool enabled() const;
+
+    /// Add a checked orphan block, false if disabled, pooled or too large.
+    bool add(block_const_ptr block);
+
+    /// Remove and return the orphans of the parent, in order of arrival.
+    block_const_ptr_list remove_children(hash_digest const& parent);
+
+    /// True if the block is pooled.
+    bool exists(hash_digest const& hash) const;
+
+    /// Remove all message vectors that match orphan block hashes.
+    void filter(get_data_ptr message) const;
+
+    /// Remove all orphans.
+    void clear();
+
+    /// Properties.
+    size_t maximum_size() const;
+    size_t maximum_count() const;
+    size_t size() const;
+    size_t count() const;
+
+private:
+    struct entry {
+        block_const_ptr block;
+        size_t bytes;
+        size_t sequence;
+    };
+
+    typedef std::list<entry> entries;
+
+    // Call under lock.
+    void erase(entries::iterator it);
+
+    // These are thread safe.
+    const size_t maximum_size_;
+    const size_t maximum_count_;
+
+    // These are protected by mutex, entries are in order of arrival (front is
+    // the oldest).
+    entries entries_;
+    std::unordered_map<hash_digest, entries::iterator> by_hash_;
+    std::unordered_multimap<hash_digest, entries::iterator> by_parent_;
+    size_t size_;
+    size_t sequence_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
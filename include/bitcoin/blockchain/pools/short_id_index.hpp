@@ -0,0 +1,77 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_SHORT_ID_INDEX_HPP
+#define LIBBITCOIN_BLOCKCHAIN_SHORT_ID_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// Contiguous array of the unconfirmed transaction hashes in the form hashed
+/// by BIP152 short ids (wtxid with witness), so that a compact block is
+/// matched against the whole pool in one parallel pass. Each hash is paired
+/// with the txid used to read the transaction from the store.
+/// This class is thread safe.
+class BCB_API short_id_index
+{
+public:
+    typedef std::vector<uint64_t> short_id_list;
+
+    /// Number of hashes computed together by the sip_hash kernel.
+    static constexpr size_t lanes = 4;
+
+    /// The BIP152 short ids (SipHash-2-4 of the hash, low six bytes) of
+    /// count contiguous hashes, lanes at a time.
+    static void sip_hash(uint64_t k0, uint64_t k1, hash_digest const* hashes,
+        size_t count, uint64_t* out);
+
+    /// Replace the pool content.
+    void reset(hash_list const& hashes, hash_list const& txids);
+
+    /// Add an unconfirmed transaction, ignored if already present.
+    void add(hash_digest const& hash, hash_digest const& txid);
+
+    /// Remove transactions by txid (swapped with the last, order is lost).
+    void remove(hash_list const& txids);
+
+    /// Short ids of all hashes and the txids at the same positions.
+    /// Hashing is split between the dispatcher threads and the caller.
+    void short_ids(uint64_t k0, uint64_t k1, dispatcher& dispatch,
+        short_id_list& out_ids, hash_list& out_txids) const;
+
+    size_t size() const;
+
+private:
+    // These are protected by mutex.
+    hash_list hashes_;
+    hash_list txids_;
+    std::unordered_map<hash_digest, size_t> positions_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
@@ -28,8 +28,10 @@
 #include <bitcoin/blockchain/define.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
 #include <bitcoin/blockchain/interface/safe_chain.hpp>
+#include <bitcoin/blockchain/pools/chain_notifier.hpp>
 #include <bitcoin/blockchain/pools/transaction_pool.hpp>
 #include <bitcoin/blockchain/settings.hpp>
+#include <bitcoin/blockchain/validate/script_cache.hpp>
 #include <bitcoin/blockchain/validate/validate_transaction.hpp>
 
 #if defined(BITPRIM_WITH_MEMPOOL)
@@ -55,9 +57,9 @@ public:
     /// Construct an instance.
 
 #if defined(BITPRIM_WITH_MEMPOOL)
-    transaction_organizer(prioritized_mutex& mutex, dispatcher& dispatch, threadpool& thread_pool, fast_chain& chain, const settings& settings, mining::mempool& mp);
+    transaction_organizer(prioritized_mutex& mutex, dispatcher& dispatch, chain_notifier& notifier, fast_chain& chain, const settings& settings, script_cache& cache, mining::mempool& mp);
 #else
-    transaction_organizer(prioritized_mutex& mutex, dispatcher& dispatch, threadpool& thread_pool, fast_chain& chain, const settings& settings);
+    transaction_organizer(prioritized_mutex& mutex, dispatcher& dispatch, chain_notifier& notifier, fast_chain& chain, const settings& settings, script_cache& cache);
 #endif
 
     bool start();
@@ -102,7 +104,7 @@ private:
     dispatcher& dispatch_;
     transaction_pool transaction_pool_;
     validate_transaction validator_;
-    transaction_subscriber::ptr subscriber_;
+    chain_notifier& notifier_;
 
 #if defined(BITPRIM_WITH_MEMPOOL)
     mining::mempool& mempool_;
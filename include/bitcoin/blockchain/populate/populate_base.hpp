@@ -44,6 +44,9 @@ protected:
 
     void populate_prevout(size_t maximum_height, const chain::output_point& outpoint, bool require_confirmed) const;
 
+    /// Bulk version of populate_prevout, outpoints must be sorted.
+    void populate_prevouts(size_t maximum_height, const fast_chain::output_point_ptr_list& outpoints, bool require_confirmed) const;
+
     // This is thread safe.
     dispatcher& dispatch_;
 
@@ -20,11 +20,13 @@
 #define LIBBITCOIN_BLOCKCHAIN_POPULATE_BLOCK_HPP
 
 #include <cstddef>
+#include <memory>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/define.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
 #include <bitcoin/blockchain/populate/populate_base.hpp>
+#include <bitcoin/blockchain/validate/input_scheduler.hpp>
 
 #if defined(BITPRIM_WITH_MEMPOOL)
 #include <bitprim/mining/mempool.hpp>
@@ -52,6 +54,7 @@ public:
 
 protected:
     using branch_ptr = branch::const_ptr;
+    using output_point_ptr_list_ptr = std::shared_ptr<fast_chain::output_point_ptr_list const>;
 
     void populate_coinbase(branch::const_ptr branch, block_const_ptr block) const;
     ////void populate_duplicate(branch_ptr branch, const chain::transaction& tx) const;
@@ -59,15 +62,15 @@ protected:
 #if defined(BITPRIM_DB_NEW)
     utxo_pool_t get_reorg_subset_conditionally(size_t first_height, size_t& out_chain_top) const;
     void populate_from_reorg_subset(chain::output_point const& outpoint, utxo_pool_t const& reorg_subset) const;
-    void populate_transaction_inputs(branch::const_ptr branch, chain::input::list const& inputs, size_t bucket, size_t buckets, size_t input_position, local_utxo_set_t const& branch_utxo, size_t first_height, size_t chain_top, utxo_pool_t const& reorg_subset) const;
+    void populate_transaction_input(branch::const_ptr branch, chain::output_point const& prevout, local_utxo_set_t const& branch_utxo, size_t first_height, size_t chain_top, utxo_pool_t const& reorg_subset) const;
 #else
-    void populate_transaction_inputs(branch::const_ptr branch, chain::input::list const& inputs, size_t bucket, size_t buckets, size_t input_position, local_utxo_set_t const& branch_utxo) const;
+    void populate_transaction_input(branch::const_ptr branch, chain::output_point const& prevout, local_utxo_set_t const& branch_utxo) const;
 #endif
 
 #if defined(BITPRIM_WITH_MEMPOOL)
-    void populate_transactions(branch::const_ptr branch, size_t bucket, size_t buckets, local_utxo_set_t const& branch_utxo, mining::mempool::hash_index_t const& validated_txs, result_handler handler) const;
+    void populate_transactions(branch::const_ptr branch, size_t bucket, size_t buckets, local_utxo_set_t const& branch_utxo, mining::mempool::validated_txs_ptr_t const& validated_txs, output_point_ptr_list_ptr prevouts, input_scheduler::ptr work, result_handler handler) const;
 #else
-    void populate_transactions(branch::const_ptr branch, size_t bucket, size_t buckets, local_utxo_set_t const& branch_utxo, result_handler handler) const;
+    void populate_transactions(branch::const_ptr branch, size_t bucket, size_t buckets, local_utxo_set_t const& branch_utxo, output_point_ptr_list_ptr prevouts, input_scheduler::ptr work, result_handler handler) const;
 #endif
 
     void populate_prevout(branch_ptr branch, chain::output_point const& outpoint, local_utxo_set_t const& branch_utxo) const;
@@ -29,7 +29,8 @@
 
 namespace libbitcoin { namespace blockchain {
 
-/// This class is NOT thread safe.
+/// This class is thread safe, but because it uses the fast chain it must not
+/// be invoked during chain writes.
 class BCB_API populate_chain_state {
 public:
     populate_chain_state(const fast_chain& chain, const settings& settings);
@@ -48,6 +49,7 @@ private:
     typedef chain::chain_state::map map;
     typedef chain::chain_state::data data;
 
+    chain::chain_state::ptr promote(branch_ptr branch) const;
     bool populate_all(data& data, branch_ptr branch) const;
     bool populate_bits(data& data, const map& map, branch_ptr branch) const;
     bool populate_versions(data& data, const map& map, branch_ptr branch) const;
@@ -69,10 +71,9 @@ private:
     const uint32_t configured_forks_;
     const config::checkpoint::list checkpoints_;
 
-    // Populate is guarded against concurrent callers but because it uses the fast
-    // chain it must not be invoked during chain writes.
+    // Population only reads the fast chain, concurrent callers do not
+    // serialize here.
     const fast_chain& fast_chain_;
-    mutable shared_mutex mutex_;
 };
 
 }} // namespace libbitcoin::blockchain
@@ -51,6 +51,11 @@ public:
     uint32_t notify_limit_hours;
     uint32_t reorganization_limit;
     config::checkpoint::list checkpoints;
+
+    /// Scripts are not verified for this block and the ancestors linked to it
+    /// by headers fed through safe_chain::add_assume_valid_headers (null hash
+    /// disables).
+    config::checkpoint assume_valid;
     bool allow_collisions;
     bool easy_blocks;
     bool retarget;
@@ -113,6 +118,33 @@ public:
     bool bip143;
     bool bip147;
 
+    /// Number of verified input scripts remembered, zero disables the cache.
+    size_t script_cache_size;
+
+    /// Bytes of recent chain blocks kept for serving peers, counting both the
+    /// block objects and their wire forms, zero disables.
+    size_t block_cache_size;
+
+    /// Number of recent blocks kept as prebuilt compact blocks, zero disables.
+    size_t compact_block_cache_count;
+
+    /// Bytes and number of out of order blocks kept until their parent
+    /// arrives, zero disables.
+    size_t orphan_pool_size;
+    size_t orphan_pool_count;
+
+    /// Blocks and transactions queued for the organizers, zero organizes on
+    /// the calling thread.
+    size_t organize_queue_blocks;
+    size_t organize_queue_transactions;
+
+    /// Notifications queued per subscriber (oldest dropped beyond it, zero
+    /// does not bound, also the most blocks of coalesced reorganizations
+    /// held for a subscriber before it is unsubscribed), and milliseconds transactions are batched for (zero
+    /// queues each transaction as it is notified).
+    size_t notification_queue_limit;
+    uint32_t notification_window_milliseconds;
+
 #if defined(BITPRIM_WITH_MEMPOOL)
     size_t mempool_max_template_size;
     size_t mempool_size_multiplier;
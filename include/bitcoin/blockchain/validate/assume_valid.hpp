@@ -0,0 +1,92 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_ASSUME_VALID_HPP
+#define LIBBITCOIN_BLOCKCHAIN_ASSUME_VALID_HPP
+
+#include <cstddef>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// The set of blocks proven to be the assume valid block or one of its
+/// ancestors. Headers are linked backwards by hash starting at the assumed
+/// hash, so a block is never trusted by its height, and headers of any other
+/// branch (including one with a block at the assumed height) are ignored.
+/// This class is thread safe.
+class BCB_API assume_valid
+{
+public:
+    /// A null checkpoint hash disables the set.
+    explicit assume_valid(config::checkpoint const& checkpoint);
+
+    assume_valid(assume_valid const&) = delete;
+    assume_valid& operator=(assume_valid const&) = delete;
+
+    bool enabled() const;
+
+    /// Add headers in any order, returns the number of newly linked ones.
+    /// Headers that do not (yet) link to the assumed hash are retained until
+    /// the assumed header arrives or the set is complete. At most as many as
+    /// the path still lacks are retained, the oldest are released first.
+    size_t add(chain::header::list const& headers);
+
+    /// True if the block is the assumed block or one of its ancestors.
+    bool contains(hash_digest const& hash) const;
+
+    /// True once the path reaches the genesis block.
+    bool complete() const;
+
+    /// Properties.
+    config::checkpoint const& checkpoint() const;
+    size_t linked() const;
+    size_t pending() const;
+
+private:
+    struct unlinked_header {
+        hash_digest parent;
+        size_t sequence;
+    };
+
+    // Call under unique lock.
+    size_t link();
+    void evict();
+
+    // This is thread safe.
+    const config::checkpoint checkpoint_;
+
+    // These are protected by mutex, cursor_ is the next hash expected on the
+    // path (null once the genesis block is linked), unlinked_ maps the hash
+    // of each retained header to its parent and arrivals_ orders them.
+    hash_digest cursor_;
+    size_t sequence_;
+    std::unordered_set<hash_digest> path_;
+    std::unordered_map<hash_digest, unlinked_header> unlinked_;
+    std::map<size_t, hash_digest> arrivals_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
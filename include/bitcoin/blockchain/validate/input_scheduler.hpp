@@ -0,0 +1,108 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_INPUT_SCHEDULER_HPP
+#define LIBBITCOIN_BLOCKCHAIN_INPUT_SCHEDULER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// Flattened (tx, input) index of a block, handed out in chunks to the
+/// threads that pull from it until the work is exhausted or cancelled.
+/// Building (add/distribute) is NOT thread safe, must be completed before
+/// sharing the instance; next/cancel/visit are thread safe.
+class BCB_API input_scheduler
+{
+public:
+    typedef std::shared_ptr<input_scheduler> ptr;
+
+    input_scheduler();
+
+    input_scheduler(input_scheduler const&) = delete;
+    input_scheduler& operator=(input_scheduler const&) = delete;
+
+    /// Append the inputs of the transaction at the given block position.
+    void add(size_t position, size_t inputs);
+
+    /// Size the chunks for the given number of workers.
+    void distribute(size_t workers);
+
+    /// Total number of scheduled inputs.
+    size_t size() const;
+
+    /// Number of scheduled transactions.
+    size_t transactions() const;
+
+    /// Claim the next chunk [first, last), false if exhausted or cancelled.
+    bool next(size_t& first, size_t& last);
+
+    /// Stop handing out chunks, i.e. after a validation failure.
+    void cancel();
+    bool cancelled() const;
+
+    /// Call handler(position, input_index) for each input of the chunk,
+    /// stops and returns false as soon as the handler returns false.
+    template <typename Handler>
+    bool visit(size_t first, size_t last, Handler handler) const {
+        BITCOIN_ASSERT(first <= last && last <= size());
+
+        // Index of the first transaction whose range contains first.
+        auto it = std::prev(std::upper_bound(offsets_.begin(), offsets_.end(), first));
+        auto slot = size_t(std::distance(offsets_.begin(), it));
+
+        for (auto input = first; input < last; ++input) {
+            while (input >= offsets_[slot + 1]) {
+                ++slot;
+            }
+
+            auto const input_index = static_cast<uint32_t>(input - offsets_[slot]);
+
+            if ( ! handler(positions_[slot], input_index)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+private:
+    // Block position of each scheduled transaction.
+    std::vector<size_t> positions_;
+
+    // Cumulative input count, offsets_[i] is the first input of positions_[i].
+    std::vector<size_t> offsets_;
+
+    size_t chunk_;
+    std::atomic<size_t> next_;
+    std::atomic<bool> cancelled_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,99 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_BLOCKCHAIN_SCRIPT_CACHE_HPP
+#define LIBBITCOIN_BLOCKCHAIN_SCRIPT_CACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_set>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/define.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+/// Bounded cache of successful input script verifications.
+/// An entry is keyed by (witness tx hash, input index, forks), so a verification
+/// done under the same rules (i.e. at mempool acceptance) is not repeated
+/// when the transaction is connected in a block.
+/// This class is thread safe.
+class BCB_API script_cache
+{
+public:
+    /// A capacity of zero disables the cache.
+    explicit script_cache(size_t capacity);
+
+    script_cache(script_cache const&) = delete;
+    script_cache& operator=(script_cache const&) = delete;
+
+    bool enabled() const;
+
+    /// True if the input script was already verified under the given forks.
+    bool contains(hash_digest const& tx_hash, uint32_t input_index, uint32_t forks) const;
+
+    /// Record a successful input script verification.
+    void add(hash_digest const& tx_hash, uint32_t input_index, uint32_t forks);
+
+    /// Properties.
+    size_t capacity() const;
+    size_t size() const;
+    size_t hits() const;
+    size_t misses() const;
+    size_t evictions() const;
+
+private:
+    struct key {
+        hash_digest hash;
+        uint32_t index;
+        uint32_t forks;
+
+        bool operator==(key const& x) const {
+            return index == x.index && forks == x.forks && hash == x.hash;
+        }
+    };
+
+    struct key_hasher {
+        size_t operator()(key const& x) const;
+    };
+
+    // Each shard has its own lock, insertion order is used for eviction.
+    struct shard {
+        mutable shared_mutex mutex;
+        std::unordered_set<key, key_hasher> entries;
+        std::deque<key> order;
+    };
+
+    shard& get_shard(key const& x) const;
+
+    const size_t capacity_;
+    const size_t shard_capacity_;
+    mutable std::vector<shard> shards_;
+
+    mutable std::atomic<size_t> hits_;
+    mutable std::atomic<size_t> misses_;
+    std::atomic<size_t> evictions_;
+};
+
+} // namespace blockchain
+} // namespace libbitcoin
+
+#endif
@@ -29,6 +29,8 @@
 #include <bitcoin/blockchain/pools/branch.hpp>
 #include <bitcoin/blockchain/populate/populate_block.hpp>
 #include <bitcoin/blockchain/settings.hpp>
+#include <bitcoin/blockchain/validate/input_scheduler.hpp>
+#include <bitcoin/blockchain/validate/script_cache.hpp>
 
 #if defined(BITPRIM_WITH_MEMPOOL)
 #include <bitprim/mining/mempool.hpp>
@@ -44,9 +46,9 @@ public:
     typedef handle0 result_handler;
 
 #if defined(BITPRIM_WITH_MEMPOOL)
-    validate_block(dispatcher& dispatch, const fast_chain& chain, const settings& settings, bool relay_transactions, mining::mempool const& mp);
+    validate_block(dispatcher& dispatch, const fast_chain& chain, const settings& settings, script_cache& cache, bool relay_transactions, mining::mempool const& mp);
 #else
-    validate_block(dispatcher& dispatch, const fast_chain& chain, const settings& settings, bool relay_transactions);
+    validate_block(dispatcher& dispatch, const fast_chain& chain, const settings& settings, script_cache& cache, bool relay_transactions);
 #endif    
 
 
@@ -82,8 +84,9 @@ private:
         result_handler handler) const;
     void handle_accepted(const code& ec, block_const_ptr block,
         atomic_counter_ptr sigops, bool bip141, result_handler handler) const;
-    void connect_inputs(block_const_ptr block, size_t bucket,
-        size_t buckets, result_handler handler) const;
+    bool is_assumed_valid(const chain::block& block) const;
+    void connect_inputs(block_const_ptr block, input_scheduler::ptr work,
+        bool verify_scripts, result_handler handler) const;
     void handle_connected(const code& ec, block_const_ptr block,
         result_handler handler) const;
 
@@ -93,6 +96,7 @@ private:
     dispatcher& priority_dispatch_;
     mutable atomic_counter hits_;
     mutable atomic_counter queries_;
+    const script_cache& script_cache_;
 
     // Caller must not invoke accept/connect concurrently.
     populate_block block_populator_;
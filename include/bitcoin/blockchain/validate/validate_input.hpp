@@ -43,8 +43,19 @@ public:
     code convert_result(consensus::verify_result_type result);
 #endif
 
+    /// Wire serialization of the transaction as expected by verify_script.
+    static
+    data_chunk transaction_data(chain::transaction const& tx);
+
+    // Signatures are checked inside consensus::verify_script as the script
+    // runs. The (pubkey, message, signature) triples are not exposed, so
+    // they cannot be collected here for batch verification per block.
     static 
     code verify_script(chain::transaction const& tx, uint32_t input_index, uint32_t forks);
+
+    /// Same as above but reusing a previously cached wire serialization.
+    static 
+    code verify_script(chain::transaction const& tx, data_chunk const& tx_data, uint32_t input_index, uint32_t forks);
 };
 
 } // namespace blockchain
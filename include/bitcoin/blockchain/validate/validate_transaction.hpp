@@ -21,12 +21,14 @@
 
 #include <atomic>
 #include <cstddef>
+#include <memory>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/define.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
 #include <bitcoin/blockchain/populate/populate_transaction.hpp>
 #include <bitcoin/blockchain/settings.hpp>
+#include <bitcoin/blockchain/validate/script_cache.hpp>
 
 #if defined(BITPRIM_WITH_MEMPOOL)
 #include <bitprim/mining/mempool.hpp>
@@ -42,9 +44,9 @@ public:
     typedef handle0 result_handler;
 
 #if defined(BITPRIM_WITH_MEMPOOL)
-    validate_transaction(dispatcher& dispatch, const fast_chain& chain, const settings& settings, mining::mempool const& mp);
+    validate_transaction(dispatcher& dispatch, const fast_chain& chain, const settings& settings, script_cache& cache, mining::mempool const& mp);
 #else
-    validate_transaction(dispatcher& dispatch, const fast_chain& chain, const settings& settings);
+    validate_transaction(dispatcher& dispatch, const fast_chain& chain, const settings& settings, script_cache& cache);
 #endif
 
     void start();
@@ -61,16 +63,19 @@ protected:
     }
 
 private:
+    typedef std::shared_ptr<const data_chunk> tx_data_ptr;
+
     void handle_populated(const code& ec, transaction_const_ptr tx,
         result_handler handler) const;
-    void connect_inputs(transaction_const_ptr tx, size_t bucket,
-        size_t buckets, result_handler handler) const;
+    void connect_inputs(transaction_const_ptr tx, tx_data_ptr tx_data,
+        size_t bucket, size_t buckets, result_handler handler) const;
 
     // These are thread safe.
     std::atomic<bool> stopped_;
     const bool retarget_;
     const fast_chain& fast_chain_;
     dispatcher& dispatch_;
+    script_cache& script_cache_;
 
     // Caller must not invoke accept/connect concurrently.
     populate_transaction transaction_populator_;
@@ -21,6 +21,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <memory>
 #include <tuple>
 #include <type_traits>
 #include <unordered_map>
@@ -324,7 +325,14 @@ public:
     using accum_t = std::tuple<uint64_t, size_t, size_t>;
     using internal_utxo_set_t = std::unordered_map<chain::point, chain::output>;
     using previous_outputs_t = std::unordered_map<chain::point, index_t>;
-    using hash_index_t = std::unordered_map<hash_digest, std::pair<index_t, chain::transaction>>;
+    using transaction_ptr_t = std::shared_ptr<chain::transaction const>;
+    using hash_index_t = std::unordered_map<hash_digest, std::pair<index_t, transaction_ptr_t>>;
+
+    // Immutable view of the validated transactions, shared with block population and
+    // inventory filtering. It is copied (pointers only) just when the mempool changes
+    // while a snapshot is still borrowed.
+    using validated_txs_t = std::unordered_map<hash_digest, transaction_ptr_t>;
+    using validated_txs_ptr_t = std::shared_ptr<validated_txs_t const>;
 
     // using mutex_t = boost::shared_mutex;
     // using shared_lock_t = boost::shared_lock<mutex_t>;
@@ -588,6 +596,7 @@ public:
             for (auto i : to_remove) {
                 auto it = std::next(all_transactions_.begin(), i);
                 hash_index_.erase(it->txid());
+                validated_txs_for_write().erase(it->txid());
                 remove_from_utxo(it->txid(), it->output_count());
 
                 if (i < all_transactions_.size() - 1) {
@@ -742,15 +751,33 @@ public:
         });
     }
 
-    hash_index_t get_validated_txs_high() const {
+    // Batch version, the whole lookup is done in a single job.
+    std::vector<bool> contains(std::vector<hash_digest> const& txids) const {
+        return prioritizer_.low_job([&txids, this]{
+            std::vector<bool> res;
+            res.reserve(txids.size());
+            for (auto const& txid : txids) {
+                res.push_back(hash_index_.find(txid) != hash_index_.end());
+            }
+            return res;
+        });
+    }
+
+    validated_txs_ptr_t get_validated_txs_high() const {
         return prioritizer_.high_job([this]{
-            return hash_index_;
+            return validated_txs_ptr_t(validated_txs_);
         });
     }
 
-    hash_index_t get_validated_txs_low() const {
+    validated_txs_ptr_t get_validated_txs_low() const {
         return prioritizer_.low_job([this]{
-            return hash_index_;
+            return validated_txs_ptr_t(validated_txs_);
+        });
+    }
+
+    size_t validated_txs_version() const {
+        return prioritizer_.low_job([this]{
+            return validated_txs_version_;
         });
     }
 
@@ -991,7 +1018,7 @@ public:
         // **FER**
         {
             for (auto const& p : hash_index_) {
-                auto const& tx_cached = p.second.second;
+                auto const& tx_cached = *p.second.second;
                 for (size_t i = 0; i < tx_cached.inputs().size(); ++i) {
                     auto const& output_cache = tx_cached.inputs()[i].previous_output().validation.cache;
                     if ( ! output_cache.is_valid()) {
@@ -1229,7 +1256,7 @@ private:
         if (it != hash_index_.end()) {
             
             it->second.first = index;
-            auto const& tx = it->second.second;
+            auto const& tx = *it->second.second;
 
             for (auto const& i : tx.inputs()) {
                 previous_outputs_.insert({i.previous_output(), index});
@@ -1568,6 +1595,15 @@ private:
 
     }
 
+    validated_txs_t& validated_txs_for_write() {
+        // Copy-on-write: somebody is still holding the current snapshot.
+        if (validated_txs_.use_count() > 1) {
+            validated_txs_ = std::make_shared<validated_txs_t>(*validated_txs_);
+        }
+        ++validated_txs_version_;
+        return *validated_txs_;
+    }
+
     error::error_code_t process_utxo_and_graph(chain::transaction const& tx, index_t node_index, node& new_node) {
         //TODO(fernando): evitar tratar de borrar en el UTXO Local, si el UTXO fue encontrado en la DB
 
@@ -1602,7 +1638,9 @@ private:
 
 
         start = std::chrono::high_resolution_clock::now();
-        hash_index_.emplace(tx.hash(), std::make_pair(node_index, tx));
+        auto tx_ptr = std::make_shared<chain::transaction const>(tx);
+        hash_index_.emplace(tx.hash(), std::make_pair(node_index, tx_ptr));
+        validated_txs_for_write().emplace(tx.hash(), std::move(tx_ptr));
         end = std::chrono::high_resolution_clock::now();
         increment_time(start, end, hash_index_emplace_time);
 
@@ -2185,6 +2223,8 @@ private:
     internal_utxo_set_t internal_utxo_set_;
     all_transactions_t all_transactions_;
     hash_index_t hash_index_;
+    std::shared_ptr<validated_txs_t> validated_txs_ {std::make_shared<validated_txs_t>()};
+    size_t validated_txs_version_ = 0;
     candidate_indexes_t candidate_transactions_;
     bool sorted_ {false};
 
@@ -18,6 +18,19 @@
  */
 #include <bitcoin/blockchain/interface/block_chain.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <boost/thread/latch.hpp>
+
 #ifdef BITPRIM_WITH_KEOKEN
 #include <bitprim/keoken/transaction_extractor.hpp>
 #endif
@@ -25,128 +38,517 @@
 namespace libbitcoin {
 namespace blockchain {
 
-#ifdef BITPRIM_DB_LEGACY
-void block_chain::for_each_transaction(size_t from, size_t to, bool witness, for_each_tx_handler const& handler) const {
-#ifdef BITPRIM_CURRENCY_BCH
-    witness = false;    //TODO(fernando): see what to do with those things!
-#endif
+#if defined(BITPRIM_DB_LEGACY) || defined(BITPRIM_DB_NEW_FULL)
+
+// Range scan.
+//-----------------------------------------------------------------------------
+
+// private
+code block_chain::read_transactions(size_t height, bool witness, transaction_list_const_ptr& out_transactions) const {
+#if defined(BITPRIM_DB_LEGACY)
+    auto const block_result = database_.blocks().get(height);
+
+    if ( ! block_result) {
+        return error::not_found;
+    }
+
+    BITCOIN_ASSERT(block_result.height() == height);
     auto const& tx_store = database_.transactions();
+    auto const tx_hashes = block_result.transaction_hashes();
+    auto transactions = std::make_shared<chain::transaction::list>();
+    transactions->reserve(tx_hashes.size());
 
-    while (from <= to) {
+    for (auto const& hash : tx_hashes) {
+        auto const tx_result = tx_store.get(hash, max_size_t, true);
 
-        if (stopped()) {
-            handler(error::service_stopped, 0, chain::transaction{});
-            return;
+        if ( ! tx_result) {
+            return error::operation_failed_16;
         }
-    
-        auto const block_result = database_.blocks().get(from);
 
-        if ( ! block_result) {
-            handler(error::not_found, 0, chain::transaction{});
-            return;
-        }
-        BITCOIN_ASSERT(block_result.height() == from);
-        auto const tx_hashes = block_result.transaction_hashes();
+        BITCOIN_ASSERT(tx_result.height() == height);
+        transactions->push_back(tx_result.transaction(witness));
+    }
 
-        for_each_tx_hash(block_result.transaction_hashes().begin(), 
-                         block_result.transaction_hashes().end(), 
-                         tx_store, from, witness, handler);
+    out_transactions = std::move(transactions);
+#else
+    auto const block = std::make_shared<const chain::block>(database_.internal_db().get_block(height));
 
-        ++from;
+    if ( ! block->is_valid()) {
+        return error::not_found;
     }
+
+    // Alias the block transactions, they are not copied.
+    out_transactions = transaction_list_const_ptr(block, &block->transactions());
+#endif
+
+    return error::success;
 }
 
-void block_chain::for_each_transaction_non_coinbase(size_t from, size_t to, bool witness, for_each_tx_handler const& handler) const {
+code block_chain::scan_transactions(size_t from, size_t to, scan_options const& options, scan_tx_handler const& handler) const {
+    if (from > to) {
+        return error::success;
+    }
+
 #ifdef BITPRIM_CURRENCY_BCH
-    witness = false;    //TODO(fernando): see what to do with those things!
+    auto const witness = false;
+#else
+    auto const witness = options.witness;
 #endif
-    auto const& tx_store = database_.transactions();
 
-    while (from <= to) {
+    auto const count = to - from + 1;
+    auto const cores = std::max(size_t(1), size_t(std::thread::hardware_concurrency()));
+    auto const threads = std::min(count, options.threads == 0 ? cores : options.threads);
+
+    // Every claimed block fits in the window, so its reader never waits on itself.
+    auto const window = std::max(options.prefetch, threads);
+    auto const first = options.coinbase ? size_t(0) : size_t(1);
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::map<size_t, transaction_list_const_ptr> ready;
+    std::atomic<bool> cancelled(false);
+    std::exception_ptr exception;
+    size_t next_read = from;
+    size_t next_delivery = from;
+
+    // Ordered: the lowest height that failed to read (and its error), heights
+    // below it are still delivered before the error is returned.
+    size_t failed = to + 1;
+    code failure = error::success;
+    code result = error::success;
+
+    auto const cancel = [&](code const& ec) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (ec && ! result) {
+            result = ec;
+        }
 
-        if (stopped()) {
-            handler(error::service_stopped, 0, chain::transaction{});
-            return;
+        cancelled = true;
+        changed.notify_all();
+    };
+
+    auto const fail = [&](size_t height, code const& ec) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (height < failed) {
+            failed = height;
+            failure = ec;
         }
-    
-        auto const block_result = database_.blocks().get(from);
 
-        if ( ! block_result) {
-            handler(error::not_found, 0, chain::transaction{});
-            return;
+        changed.notify_all();
+    };
+
+    // Returns false if the handler cancelled the scan.
+    auto const deliver = [&](size_t height, transaction_list_const_ptr const& transactions) {
+        for (auto position = first; position < transactions->size(); ++position) {
+            if (cancelled) {
+                return false;
+            }
+
+            auto const& tx = (*transactions)[position];
+            auto const tx_ptr = options.borrowed ?
+                transaction_const_ptr(transactions, &tx) :
+                std::make_shared<const chain::transaction>(tx);
+
+            if ( ! handler(height, position, tx_ptr)) {
+                return false;
+            }
         }
-        BITCOIN_ASSERT(block_result.height() == from);
-        auto const tx_hashes = block_result.transaction_hashes();
 
-        for_each_tx_hash(std::next(block_result.transaction_hashes().begin()), 
-                         block_result.transaction_hashes().end(), 
-                         tx_store, from, witness, handler);
+        return true;
+    };
+
+    auto const read = [&]() {
+        while (true) {
+            size_t height;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+
+                // Ordered readers stay within the window ahead of delivery.
+                changed.wait(lock, [&]() {
+                    return cancelled || next_read > to || next_read >= failed ||
+                        ! options.ordered || next_read - next_delivery < window;
+                });
 
-        ++from;
+                if (cancelled || next_read > to || next_read >= failed) {
+                    return;
+                }
+
+                height = next_read++;
+            }
+
+            if (stopped()) {
+                cancel(error::service_stopped);
+                return;
+            }
+
+            transaction_list_const_ptr transactions;
+            auto const ec = read_transactions(height, witness, transactions);
+
+            if (ec) {
+                if (options.ordered) {
+                    fail(height, ec);
+                } else {
+                    cancel(ec);
+                }
+
+                return;
+            }
+
+            if ( ! options.ordered) {
+                if ( ! deliver(height, transactions)) {
+                    cancel(error::success);
+                    return;
+                }
+
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            ready.emplace(height, std::move(transactions));
+            changed.notify_all();
+        }
+    };
+
+    // A throwing handler (unordered) or read cancels the scan, the first
+    // exception is rethrown to the caller once the readers are joined.
+    auto const guarded_read = [&]() {
+        try {
+            read();
+        } catch (...) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+
+                if ( ! exception) {
+                    exception = std::current_exception();
+                }
+            }
+
+            cancel(error::success);
+        }
+    };
+
+    std::vector<std::thread> readers;
+    readers.reserve(threads);
+
+    auto const join = [&readers]() {
+        for (auto& reader : readers) {
+            if (reader.joinable()) {
+                reader.join();
+            }
+        }
+    };
+
+    try {
+        for (size_t thread = 0; thread < threads; ++thread) {
+            readers.emplace_back(guarded_read);
+        }
+
+        // Ordered delivery happens on the calling thread, in height order.
+        while (options.ordered && next_delivery <= to) {
+            transaction_list_const_ptr transactions;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&]() {
+                    return cancelled || next_delivery >= failed ||
+                        ready.count(next_delivery) != 0;
+                });
+
+                if (cancelled || next_delivery >= failed) {
+                    break;
+                }
+
+                auto const it = ready.find(next_delivery);
+                transactions = std::move(it->second);
+                ready.erase(it);
+            }
+
+            if ( ! deliver(next_delivery, transactions)) {
+                cancel(error::success);
+                break;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            ++next_delivery;
+            changed.notify_all();
+        }
+    } catch (...) {
+        // Joinable threads must not be destroyed by the unwinding.
+        cancel(error::success);
+        join();
+        throw;
     }
-}
-#endif // BITPRIM_DB_LEGACY
 
+    join();
+
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+
+    // Not reached if the handler cancelled the scan first.
+    if ( ! result && next_delivery == failed) {
+        return failure;
+    }
+
+    return result;
+}
 
-#ifdef BITPRIM_DB_NEW_FULL
 void block_chain::for_each_transaction(size_t from, size_t to, bool witness, for_each_tx_handler const& handler) const {
-#ifdef BITPRIM_CURRENCY_BCH
-    witness = false;    //TODO(fernando): see what to do with those things!
-#endif
-    
-    while (from <= to) {
+    scan_options options;
+    options.witness = witness;
 
-        if (stopped()) {
-            handler(error::service_stopped, 0, chain::transaction{});
-            return;
+    auto const ec = scan_transactions(from, to, options, [&handler](size_t height, size_t, transaction_const_ptr tx) {
+        handler(error::success, height, *tx);
+        return true;
+    });
+
+    if (ec) {
+        handler(ec, 0, chain::transaction{});
+    }
+}
+
+void block_chain::for_each_transaction_non_coinbase(size_t from, size_t to, bool witness, for_each_tx_handler const& handler) const {
+    scan_options options;
+    options.witness = witness;
+    options.coinbase = false;
+
+    auto const ec = scan_transactions(from, to, options, [&handler](size_t height, size_t, transaction_const_ptr tx) {
+        handler(error::success, height, *tx);
+        return true;
+    });
+
+    if (ec) {
+        handler(ec, 0, chain::transaction{});
+    }
+}
+
+#endif // defined(BITPRIM_DB_LEGACY) || defined(BITPRIM_DB_NEW_FULL)
+
+// Batch queries.
+//-----------------------------------------------------------------------------
+// Keys are looked up in sorted order (store locality), in contiguous runs
+// pulled by the query threads and the caller. Results are in request order
+// and delivered in a single call.
+
+// Below this many keys per thread the dispatch costs more than it saves.
+static constexpr size_t minimum_batch_bucket = 64;
+
+template <typename Key>
+static std::vector<size_t> sorted_order(std::vector<Key> const& keys) {
+    std::vector<size_t> order(keys.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::sort(order.begin(), order.end(), [&keys](size_t a, size_t b) {
+        return keys[a] < keys[b];
+    });
+    return order;
+}
+
+// The buckets of one batch, pulled by whichever thread gets to them first.
+// Dispatched pulls may run after the caller has returned (or never, once the
+// query pool is stopped), so they only touch this shared state.
+struct batch_state {
+    batch_state(size_t key_count, size_t bucket_count, std::vector<size_t> const& key_order, std::function<void(size_t)> const& key_lookup)
+        : count(key_count)
+        , buckets(bucket_count)
+        , bucket_size((key_count + bucket_count - 1) / bucket_count)
+        , order(key_order)
+        , lookup(key_lookup)
+        , next(0)
+        , failed(false)
+        , remaining(buckets)
+    {}
+
+    // Returns when no bucket is left to claim. The order and lookup are only
+    // read for a claimed bucket, which the caller waits for.
+    void pull() {
+        size_t bucket;
+
+        while ((bucket = next++) < buckets) {
+            if ( ! failed) {
+                run(bucket);
+            }
+
+            remaining.count_down();
         }
-    
-        auto const block_result = database_.internal_db().get_block(from);
+    }
 
-        if ( ! block_result.is_valid()) {
-            handler(error::not_found, 0, chain::transaction{});
-            return;
+    void run(size_t bucket) {
+        auto const first = std::min(count, bucket * bucket_size);
+        auto const last = std::min(count, first + bucket_size);
+
+        try {
+            for (auto index = first; index < last; ++index) {
+                lookup(order[index]);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(exception_mutex);
+
+            if ( ! exception) {
+                exception = std::current_exception();
+            }
+
+            failed = true;
         }
+    }
 
-        //BITCOIN_ASSERT(block_result.height() == from);
-        //auto const tx_hashes = block_result.transaction_hashes();
+    size_t const count;
+    size_t const buckets;
+    size_t const bucket_size;
+    std::vector<size_t> const& order;
+    std::function<void(size_t)> const& lookup;
+    std::atomic<size_t> next;
+    std::atomic<bool> failed;
+    boost::latch remaining;
+    std::mutex exception_mutex;
+    std::exception_ptr exception;
+};
+
+// private
+// The caller pulls buckets too, so the batch completes even if no query
+// thread gets to it. A lookup exception skips the unstarted buckets and is
+// rethrown to the caller.
+void block_chain::batch_lookup(std::vector<size_t> const& order, std::function<void(size_t)> const& lookup) const {
+    auto const count = order.size();
+    auto const buckets = std::max(size_t(1), std::min(query_dispatch_.size() + 1, count / minimum_batch_bucket));
+    auto const state = std::make_shared<batch_state>(count, buckets, order, lookup);
+
+    for (size_t bucket = 1; bucket < buckets; ++bucket) {
+        query_dispatch_.concurrent([state]() {
+            state->pull();
+        });
+    }
 
-        for_each_tx_valid(block_result.transactions().begin(), 
-                         block_result.transactions().end(), from, witness, handler);
+    state->pull();
+    state->remaining.wait();
 
-        ++from;
+    if (state->exception) {
+        std::rethrow_exception(state->exception);
     }
 }
 
-void block_chain::for_each_transaction_non_coinbase(size_t from, size_t to, bool witness, for_each_tx_handler const& handler) const {
+// Heights above the top are not returned, so the list may be short.
+void block_chain::fetch_block_headers(size_t from, size_t count, block_headers_fetch_handler handler) const {
+    if (stopped()) {
+        handler(error::service_stopped, {});
+        return;
+    }
+
+    size_t top;
+
+    if ( ! get_last_height(top)) {
+        handler(error::operation_failed, {});
+        return;
+    }
+
+    count = from > top ? 0 : std::min(count, top - from + 1);
+
+    // Heights are already in store order.
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), size_t(0));
+    chain::header::list headers(count);
+
+    batch_lookup(order, [&](size_t index) {
+        auto const height = from + index;
+#if defined(BITPRIM_DB_LEGACY)
+        auto const result = database_.blocks().get(height);
+
+        if (result) {
+            headers[index] = result.header();
+        }
+#else
+        auto const cached = block_cache_.peek(height);
+        headers[index] = cached ? cached->header() : database_.internal_db().get_header(height);
+#endif
+    });
+
+    handler(error::success, headers);
+}
+
+#if defined(BITPRIM_DB_LEGACY) || defined(BITPRIM_DB_NEW_FULL)
+void block_chain::fetch_transactions(hash_list const& hashes, bool require_confirmed, bool witness, transactions_fetch_handler handler) const {
 #ifdef BITPRIM_CURRENCY_BCH
-    witness = false;    //TODO(fernando): see what to do with those things!
+    witness = false;
 #endif
-    //auto const& tx_store = database_.transactions();
+    if (stopped()) {
+        handler(error::service_stopped, {});
+        return;
+    }
 
-    while (from <= to) {
+    std::vector<transaction_lookup> transactions(hashes.size(), transaction_lookup{nullptr, 0, 0});
+
+    batch_lookup(sorted_order(hashes), [&](size_t index) {
+        auto& out = transactions[index];
+#if defined(BITPRIM_DB_LEGACY)
+        auto const result = database_.transactions().get(hashes[index], max_size_t, require_confirmed);
+
+        if (result) {
+            out = {std::make_shared<const transaction>(result.transaction(witness)), result.position(), result.height()};
+        }
+#else
+        auto const result = database_.internal_db().get_transaction(hashes[index], max_size_t);
 
-        if (stopped()) {
-            handler(error::service_stopped, 0, chain::transaction{});
+        if (result.is_valid()) {
+            out = {std::make_shared<const transaction>(result.transaction()), result.position(), result.height()};
             return;
         }
-    
-        auto const block_result = database_.internal_db().get_block(from);
 
-        if ( ! block_result.is_valid()) {
-            handler(error::not_found, 0, chain::transaction{});
+        if (require_confirmed) {
             return;
         }
-        //BITCOIN_ASSERT(block_result.height() == from);
-        auto const tx_hashes = block_result.transactions();
 
-        for_each_tx_valid(std::next(tx_hashes.begin()), 
-                         tx_hashes.end(), from, witness, handler);
+        auto const unconfirmed = database_.internal_db().get_transaction_unconfirmed(hashes[index]);
+
+        if (unconfirmed.is_valid()) {
+            out = {std::make_shared<const transaction>(unconfirmed.transaction()), position_max, unconfirmed.height()};
+        }
+#endif
+    });
+
+    handler(error::success, transactions);
+}
+#endif // defined(BITPRIM_DB_LEGACY) || defined(BITPRIM_DB_NEW_FULL)
+
+#if defined(BITPRIM_DB_SPENDS) || defined(BITPRIM_DB_NEW_FULL)
+void block_chain::fetch_spends(chain::output_point::list const& outpoints, spends_fetch_handler handler) const {
+    if (stopped()) {
+        handler(error::service_stopped, {});
+        return;
+    }
+
+    chain::input_point::list spends(outpoints.size());
+
+    batch_lookup(sorted_order(outpoints), [&](size_t index) {
+#if defined(BITPRIM_DB_SPENDS)
+        spends[index] = database_.spends().get(outpoints[index]);
+#else
+        spends[index] = database_.internal_db().get_spend(outpoints[index]);
+#endif
+    });
+
+    handler(error::success, spends);
+}
+#endif // defined(BITPRIM_DB_SPENDS) || defined(BITPRIM_DB_NEW_FULL)
 
-        ++from;
+#ifdef BITPRIM_DB_NEW
+void block_chain::fetch_utxos(chain::output_point::list const& outpoints, utxos_fetch_handler handler) const {
+    if (stopped()) {
+        handler(error::service_stopped, {});
+        return;
     }
+
+    std::vector<utxo_lookup> utxos(outpoints.size(), utxo_lookup{{}, 0, 0, false});
+
+    batch_lookup(sorted_order(outpoints), [&](size_t index) {
+        auto& out = utxos[index];
+        get_utxo(out.output, out.height, out.median_time_past, out.coinbase, outpoints[index], max_size_t);
+    });
+
+    handler(error::success, utxos);
 }
-#endif // BITPRIM_DB_NEW_FULL
+#endif // BITPRIM_DB_NEW
 
 #if defined(BITPRIM_WITH_KEOKEN)
 
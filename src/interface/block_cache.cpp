@@ -0,0 +1,340 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/interface/block_cache.hpp>
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+block_cache::block_cache(size_t capacity)
+    : capacity_(capacity)
+    , size_(0)
+    , generation_(0)
+    , hits_(0)
+    , misses_(0)
+{}
+
+bool block_cache::enabled() const {
+    return capacity_ != 0;
+}
+
+// The serialized bytes, the objects holding them and the script bytes once
+// more, for the operations parsed (and kept) by validation.
+size_t block_cache::footprint(message::block const& block) {
+    auto bytes = sizeof(message::block) +
+        block.serialized_size(message::version::level::canonical);
+
+    for (auto const& tx : block.transactions()) {
+        bytes += sizeof(chain::transaction);
+
+        for (auto const& input : tx.inputs()) {
+            bytes += sizeof(chain::input) + input.script().serialized_size(false);
+        }
+
+        for (auto const& output : tx.outputs()) {
+            bytes += sizeof(chain::output) + output.script().serialized_size(false);
+        }
+    }
+
+    return bytes;
+}
+
+// private, call under lock.
+void block_cache::erase(entries::iterator it) const {
+    by_hash_.erase(it->block->hash());
+    by_height_.erase(it->height);
+    size_ -= it->bytes;
+    entries_.erase(it);
+}
+
+// private, call under lock.
+block_const_ptr block_cache::touch(entries::iterator it, size_t& out_height) const {
+    entries_.splice(entries_.begin(), entries_, it);
+    out_height = it->height;
+    return it->block;
+}
+
+// private, call under lock.
+void block_cache::insert(block_const_ptr block, size_t height, size_t bytes) {
+    auto const by_hash = by_hash_.find(block->hash());
+    if (by_hash != by_hash_.end()) {
+        erase(by_hash->second);
+    }
+
+    auto const by_height = by_height_.find(height);
+    if (by_height != by_height_.end()) {
+        erase(by_height->second);
+    }
+
+    while ( ! entries_.empty() && size_ + bytes > capacity_) {
+        erase(std::prev(entries_.end()));
+    }
+
+    entries_.push_front({block, height, bytes, nullptr});
+    by_hash_.emplace(block->hash(), entries_.begin());
+    by_height_.emplace(height, entries_.begin());
+    size_ += bytes;
+}
+
+void block_cache::add(block_const_ptr block, size_t height) {
+    if ( ! enabled() || ! block) {
+        return;
+    }
+
+    auto const bytes = footprint(*block);
+    auto const wire = block->serialized_size(message::version::level::canonical);
+
+    // A block larger than the cache (with its wire form) would just flush it.
+    if (bytes + wire > capacity_) {
+        return;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+    insert(block, height, bytes);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void block_cache::add(block_const_ptr block, size_t height, size_t generation) {
+    if ( ! enabled() || ! block) {
+        return;
+    }
+
+    auto const bytes = footprint(*block);
+    auto const wire = block->serialized_size(message::version::level::canonical);
+
+    if (bytes + wire > capacity_) {
+        return;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    // The block may have been read from a chain since reorganized.
+    if (generation != generation_) {
+        return;
+    }
+
+    insert(block, height, bytes);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void block_cache::remove_above(size_t height) {
+    if ( ! enabled()) {
+        return;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+    ++generation_;
+
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        auto const current = it++;
+
+        if (current->height > height) {
+            erase(current);
+        }
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+block_const_ptr block_cache::get(hash_digest const& hash, size_t& out_height) const {
+    if ( ! enabled()) {
+        return nullptr;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    auto const it = by_hash_.find(hash);
+    if (it == by_hash_.end()) {
+        ++misses_;
+        return nullptr;
+    }
+
+    ++hits_;
+    return touch(it->second, out_height);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+block_const_ptr block_cache::get(size_t height) const {
+    if ( ! enabled()) {
+        return nullptr;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    auto const it = by_height_.find(height);
+    if (it == by_height_.end()) {
+        ++misses_;
+        return nullptr;
+    }
+
+    ++hits_;
+    size_t out_height;
+    return touch(it->second, out_height);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Locator and header queries read many heights, which must not displace the
+// blocks being served or count as hits.
+block_const_ptr block_cache::peek(size_t height) const {
+    if ( ! enabled()) {
+        return nullptr;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    auto const it = by_height_.find(height);
+    return it == by_height_.end() ? nullptr : it->second->block;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+// Serialize outside of the lock, the first requester stores the result.
+block_cache::data_ptr block_cache::serialize(block_const_ptr block, size_t height) const {
+    auto const data = std::make_shared<const data_chunk>(
+        block->to_data(message::version::level::canonical));
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    auto const it = by_height_.find(height);
+
+    if (it == by_height_.end() || it->second->block != block) {
+        return data;
+    }
+
+    auto const cached = it->second;
+
+    if ( ! cached->data) {
+        cached->data = data;
+        cached->bytes += data->size();
+        size_ += data->size();
+
+        // The entry was touched to the front, older entries make room.
+        while (size_ > capacity_ && std::prev(entries_.end()) != cached) {
+            erase(std::prev(entries_.end()));
+        }
+    }
+
+    return cached->data;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+block_cache::data_ptr block_cache::get_data(hash_digest const& hash, size_t& out_height) const {
+    if ( ! enabled()) {
+        return nullptr;
+    }
+
+    block_const_ptr block;
+
+    {
+        unique_lock lock(mutex_);
+
+        auto const it = by_hash_.find(hash);
+        if (it == by_hash_.end()) {
+            ++misses_;
+            return nullptr;
+        }
+
+        ++hits_;
+        block = touch(it->second, out_height);
+
+        if (it->second->data) {
+            return it->second->data;
+        }
+    }
+
+    return serialize(block, out_height);
+}
+
+block_cache::data_ptr block_cache::get_data(size_t height) const {
+    if ( ! enabled()) {
+        return nullptr;
+    }
+
+    block_const_ptr block;
+
+    {
+        unique_lock lock(mutex_);
+
+        auto const it = by_height_.find(height);
+        if (it == by_height_.end()) {
+            ++misses_;
+            return nullptr;
+        }
+
+        ++hits_;
+        size_t out_height;
+        block = touch(it->second, out_height);
+
+        if (it->second->data) {
+            return it->second->data;
+        }
+    }
+
+    return serialize(block, height);
+}
+
+// Properties.
+//-----------------------------------------------------------------------------
+
+size_t block_cache::capacity() const {
+    return capacity_;
+}
+
+size_t block_cache::generation() const {
+    shared_lock lock(mutex_);
+    return generation_;
+}
+
+size_t block_cache::size() const {
+    shared_lock lock(mutex_);
+    return size_;
+}
+
+size_t block_cache::count() const {
+    shared_lock lock(mutex_);
+    return entries_.size();
+}
+
+size_t block_cache::hits() const {
+    return hits_;
+}
+
+size_t block_cache::misses() const {
+    return misses_;
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
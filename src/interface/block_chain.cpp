@@ -84,6 +84,15 @@ using namespace std::placeholders;
 
 static auto const hour_seconds = 3600u;
 
+// Cached blocks carry their witness, so stripped requests bypass the cache.
+inline bool use_block_cache(bool witness) {
+#ifdef BITPRIM_CURRENCY_BCH
+    return true;
+#else
+    return witness;
+#endif
+}
+
 block_chain::block_chain(threadpool& pool,
     const blockchain::settings& chain_settings,
     const database::settings& database_settings,  bool relay_transactions)
@@ -92,19 +101,41 @@ block_chain::block_chain(threadpool& pool,
     , notify_limit_seconds_(chain_settings.notify_limit_hours * hour_seconds)
     , chain_state_populator_(*this, chain_settings)
     , database_(database_settings)
+#ifdef BITPRIM_DB_NEW
+    , header_index_file_(database_settings.directory / "header_index")
+#endif
     , validation_mutex_(database_settings.flush_writes && relay_transactions)
     , priority_pool_(thread_ceiling(chain_settings.cores)
     , priority(chain_settings.priority))
     , dispatch_(priority_pool_, NAME "_priority")
+    , query_pool_(thread_ceiling(chain_settings.cores))
+    , query_dispatch_(query_pool_, NAME "_query")
+    , script_cache_(chain_settings.script_cache_size)
+    , assume_valid_(chain_settings.assume_valid)
+    , block_cache_(chain_settings.block_cache_size)
+    , compact_block_cache_(chain_settings.compact_block_cache_count)
+    , notifier_(pool, chain_settings.notification_queue_limit,
+        std::chrono::milliseconds(chain_settings.notification_window_milliseconds))
 
 #if defined(BITPRIM_WITH_MEMPOOL)
     , mempool_(chain_settings.mempool_max_template_size, chain_settings.mempool_size_multiplier)
-    , transaction_organizer_(validation_mutex_, dispatch_, pool, *this, chain_settings, mempool_)
-    , block_organizer_(validation_mutex_, dispatch_, pool, *this, chain_settings, relay_transactions, mempool_)
+    , transaction_organizer_(validation_mutex_, dispatch_, notifier_, *this, chain_settings, script_cache_, mempool_)
+    , block_organizer_(validation_mutex_, dispatch_, notifier_, *this, chain_settings, script_cache_, relay_transactions, mempool_)
 #else
-    , transaction_organizer_(validation_mutex_, dispatch_, pool, *this, chain_settings)
-    , block_organizer_(validation_mutex_, dispatch_, pool, *this, chain_settings, relay_transactions)
+    , transaction_organizer_(validation_mutex_, dispatch_, notifier_, *this, chain_settings, script_cache_)
+    , block_organizer_(validation_mutex_, dispatch_, notifier_, *this, chain_settings, script_cache_, relay_transactions)
 #endif
+    , organize_queue_(chain_settings.organize_queue_blocks,
+        chain_settings.organize_queue_transactions,
+        [this](block_const_ptr block, result_handler handler) {
+            block_organizer_.check(block, handler);
+        },
+        [this](block_const_ptr block, result_handler handler) {
+            block_organizer_.organize_checked(block, handler);
+        },
+        [this](transaction_const_ptr tx, result_handler handler) {
+            transaction_organizer_.organize(tx, handler);
+        })
 {}
 
 // ============================================================================
@@ -358,9 +389,11 @@ void block_chain::set_database_flags() {
 //     return true;
 // }
 
+// The header queries below are served from the in-memory header index.
+
 bool block_chain::get_block_exists(hash_digest const& block_hash) const {
-    
-    return database_.internal_db().get_header(block_hash).first.is_valid();
+    size_t height;
+    return header_index_.get_height(height, block_hash);
 }
 
 bool block_chain::get_block_exists_safe(hash_digest const& block_hash) const {
@@ -369,25 +402,12 @@ bool block_chain::get_block_exists_safe(hash_digest const& block_hash) const {
 }
 
 bool block_chain::get_block_hash(hash_digest& out_hash, size_t height) const {
-   
-    auto const result = database_.internal_db().get_header(height);
-    if ( ! result.is_valid()) return false;
-    out_hash = result.hash();
-    return true;
+    return header_index_.get_hash(out_hash, height);
 }
 
-bool block_chain::get_branch_work(uint256_t& out_work, uint256_t const& maximum, size_t from_height) const {
-    
-    size_t top;
-    if ( ! get_last_height(top)) return false;
-
-    out_work = 0;
-    for (uint32_t height = from_height; height <= top && out_work < maximum; ++height) {
-        auto const result = database_.internal_db().get_header(height);
-        if ( ! result.is_valid()) return false;
-        out_work += chain::header::proof(result.bits());
-    }
-
+// The index holds cumulative work, so this is a single subtraction.
+bool block_chain::get_branch_work(uint256_t& out_work, uint256_t const& /*maximum*/, size_t from_height) const {
+    out_work = header_index_.get_work_above(from_height);
     return true;
 }
 
@@ -397,35 +417,19 @@ bool block_chain::get_header(chain::header& out_header, size_t height) const {
 }
 
 bool block_chain::get_height(size_t& out_height, hash_digest const& block_hash) const {
-   
-    auto result = database_.internal_db().get_header(block_hash);
-    if ( ! result.first.is_valid()) return false;
-    out_height = result.second;
-    return true;
+    return header_index_.get_height(out_height, block_hash);
 }
 
 bool block_chain::get_bits(uint32_t& out_bits, size_t height) const {
-   
-    auto result = database_.internal_db().get_header(height);
-    if ( ! result.is_valid()) return false;
-    out_bits = result.bits();
-    return true;
+    return header_index_.get_bits(out_bits, height);
 }
 
 bool block_chain::get_timestamp(uint32_t& out_timestamp, size_t height) const {
-   
-    auto result = database_.internal_db().get_header(height);
-    if ( ! result.is_valid()) return false;
-    out_timestamp = result.timestamp();
-    return true;
+    return header_index_.get_timestamp(out_timestamp, height);
 }
 
 bool block_chain::get_version(uint32_t& out_version, size_t height) const {
-  
-    auto result = database_.internal_db().get_header(height);
-    if ( ! result.is_valid()) return false;
-    out_version = result.version();
-    return true;
+    return header_index_.get_version(out_version, height);
 }
 
 bool block_chain::get_last_height(size_t& out_height) const {
@@ -449,6 +453,73 @@ bool block_chain::get_utxo(chain::output& out_output, size_t& out_height, uint32
     return true;
 }
 
+void block_chain::get_utxos(output_point_ptr_list const& outpoints, size_t branch_height) const {
+    BITCOIN_ASSERT(std::is_sorted(outpoints.begin(), outpoints.end(), [](chain::output_point const* a, chain::output_point const* b) {
+        return *a < *b;
+    }));
+
+    // The UTXO Set is keyed by outpoint, sorted lookups read it sequentially.
+    for (auto const outpoint : outpoints) {
+        auto& prevout = outpoint->validation;
+        get_utxo(prevout.cache, prevout.height, prevout.median_time_past, prevout.coinbase, *outpoint, branch_height);
+    }
+}
+
+// private
+// Rebuild the header index from the store, above from_height - 1.
+bool block_chain::index_headers(size_t from_height) {
+    if (from_height == 0) {
+        header_index_.clear();
+    } else {
+        header_index_.truncate(from_height - 1);
+    }
+
+    uint32_t top;
+    if (database_.internal_db().get_last_height(top) != result_code::success) {
+        return false;
+    }
+
+    header_index_.reserve(size_t(top) + 1);
+
+    for (size_t height = header_index_.size(); height <= top; ++height) {
+        auto const header = database_.internal_db().get_header(height);
+        if ( ! header.is_valid()) {
+            return false;
+        }
+
+        header_index_.push(header);
+    }
+
+    return true;
+}
+
+// private
+// Use the snapshot saved on close when it is still on the store chain.
+bool block_chain::load_header_index() {
+    uint32_t top;
+    if (database_.internal_db().get_last_height(top) != result_code::success) {
+        return false;
+    }
+
+    size_t indexed;
+    if ( ! header_index_.load(header_index_file_) || ! header_index_.top_height(indexed)) {
+        return index_headers(0);
+    }
+
+    // The snapshot top hash commits to all of its ancestors.
+    auto const height = std::min(indexed, size_t(top));
+    auto const header = database_.internal_db().get_header(height);
+    hash_digest hash;
+
+    if ( ! header.is_valid() || ! header_index_.get_hash(hash, height) || hash != header.hash()) {
+        LOG_INFO(LOG_BLOCKCHAIN) << "Header index snapshot is stale, rebuilding from the store.";
+        return index_headers(0);
+    }
+
+    header_index_.truncate(height);
+    return index_headers(height + 1);
+}
+
 std::pair<bool, database::internal_database::utxo_pool_t> block_chain::get_utxo_pool_from(uint32_t from, uint32_t to) const {
     auto p = database_.internal_db().get_utxo_pool_from(from, to);
 
@@ -488,7 +559,21 @@ bool block_chain::end_insert() const {
 #endif // BITPRIM_DB_LEGACY
 
 bool block_chain::insert(block_const_ptr block, size_t height) {
+#ifdef BITPRIM_DB_NEW
+    if (database_.insert(*block, height) != error::success) {
+        return false;
+    }
+
+    // Keep the header index in step with the store.
+    if (height != header_index_.size()) {
+        return index_headers(height);
+    }
+
+    header_index_.push(block->header());
+    return true;
+#else
     return database_.insert(*block, height) == error::success;
+#endif
 }
 
 void block_chain::push(transaction_const_ptr tx, dispatcher&, result_handler handler) {
@@ -497,7 +582,21 @@ void block_chain::push(transaction_const_ptr tx, dispatcher&, result_handler han
     //last_transaction_.store(tx);
 
     // Transaction push is currently sequential so dispatch is not used.
-    handler(database_.push(*tx, chain_state()->enabled_forks()));
+    auto const ec = database_.push(*tx, chain_state()->enabled_forks());
+
+#if defined(BITPRIM_DB_TRANSACTION_UNCONFIRMED) || defined(BITPRIM_DB_NEW_FULL)
+#ifdef BITPRIM_CURRENCY_BCH
+    static constexpr bool witness = false;
+#else
+    static constexpr bool witness = true;
+#endif
+
+    if ( ! ec) {
+        unconfirmed_short_ids_.add(tx->hash(witness), tx->hash());
+    }
+#endif
+
+    handler(ec);
 }
 
 #ifdef BITPRIM_DB_TRANSACTION_UNCONFIRMED
@@ -533,30 +632,150 @@ void block_chain::reorganize(const checkpoint& fork_point,
         return;
     }
 
+    // Compact before the store write, while the pool still has the txs.
+    // This runs in the organizer critical section, so it is skipped while
+    // stale (no compact block peers), a request then compacts on demand.
+    auto const compact_blocks = is_stale_fast() ?
+        std::vector<compact_block_ptr>(incoming_blocks->size()) :
+        to_compact_blocks(*incoming_blocks);
+
     // The top (back) block is used to update the chain state.
     auto const complete =
         std::bind(&block_chain::handle_reorganize,
-            this, _1, incoming_blocks->back(), handler);
+            this, _1, fork_point.height(), incoming_blocks, outgoing_blocks,
+            compact_blocks, handler);
 
     database_.reorganize(fork_point, incoming_blocks, outgoing_blocks,
         dispatch, complete);
 }
 
-void block_chain::handle_reorganize(const code& ec, block_const_ptr top,
+// Transactions of the block that are in our unconfirmed pool.
+std::vector<bool> block_chain::pooled_transactions(chain::block const& block) const
+{
+    auto const& txs = block.transactions();
+
+#if defined(BITPRIM_WITH_MEMPOOL)
+    hash_list tx_hashes;
+    tx_hashes.reserve(txs.size());
+
+    for (auto const& tx: txs)
+        tx_hashes.push_back(tx.hash());
+
+    return mempool_.contains(tx_hashes);
+#elif defined(BITPRIM_DB_NEW)
+    std::vector<bool> pooled;
+    pooled.reserve(txs.size());
+
+    for (auto const& tx: txs)
+        pooled.push_back(database_.internal_db().get_transaction_unconfirmed(
+            tx.hash()).is_valid());
+
+    return pooled;
+#elif defined(BITPRIM_DB_TRANSACTION_UNCONFIRMED)
+    std::vector<bool> pooled;
+    pooled.reserve(txs.size());
+
+    for (auto const& tx: txs)
+        pooled.push_back(bool(database_.transactions_unconfirmed().get(
+            tx.hash())));
+
+    return pooled;
+#else
+    // Without an unconfirmed pool only the coinbase is prefilled.
+    return {};
+#endif
+}
+
+// Only the blocks that would remain in the compact block cache are compacted.
+std::vector<compact_block_ptr> block_chain::to_compact_blocks(
+    block_const_ptr_list const& blocks) const
+{
+#ifdef BITPRIM_CURRENCY_BCH
+    static constexpr bool witness = false;
+#else
+    static constexpr bool witness = true;
+#endif
+
+    std::vector<compact_block_ptr> compacts(blocks.size());
+    auto const count = std::min(blocks.size(), compact_block_cache_.capacity());
+
+    for (auto index = blocks.size() - count; index < blocks.size(); ++index)
+    {
+        auto const& block = *blocks[index];
+        compacts[index] = compact_block_cache::create(block,
+            pooled_transactions(block), witness);
+    }
+
+    return compacts;
+}
+
+void block_chain::handle_reorganize(const code& ec, size_t fork_height,
+    block_const_ptr_list_const_ptr incoming_blocks,
+    block_const_ptr_list_const_ptr outgoing_blocks,
+    std::vector<compact_block_ptr> const& compact_blocks,
     result_handler handler)
 {
+    // Outgoing blocks are no longer served, whether or not the reorg stuck.
+    block_cache_.remove_above(fork_height);
+    compact_block_cache_.remove_above(fork_height);
+
+#ifdef BITPRIM_DB_NEW
     if (ec)
     {
+        // The store may be partially reorganized, resync from the fork point.
+        index_headers(fork_height + 1);
         handler(ec);
         return;
     }
 
+    // Replace the outgoing headers with the incoming ones (no store reads).
+    header_index_.truncate(fork_height);
+
+    for (auto const& block: *incoming_blocks)
+        header_index_.push(block->header());
+#else
+    if (ec)
+    {
+        handler(ec);
+        return;
+    }
+#endif // BITPRIM_DB_NEW
+
+    auto const top = incoming_blocks->back();
+
     if (!top->validation.state)
     {
         handler(error::operation_failed_14);
         return;
     }
 
+    // Newly connected blocks are the most requested by peers.
+    auto height = fork_height;
+
+    for (size_t index = 0; index < incoming_blocks->size(); ++index)
+    {
+        block_cache_.add((*incoming_blocks)[index], ++height);
+        compact_block_cache_.add(compact_blocks[index], height);
+    }
+
+#if defined(BITPRIM_DB_TRANSACTION_UNCONFIRMED) || defined(BITPRIM_DB_NEW_FULL)
+    // Outgoing txs may return to the pool, which is then reindexed (rare).
+    if (outgoing_blocks->empty())
+    {
+        hash_list confirmed;
+
+        for (auto const& block: *incoming_blocks)
+            for (auto const& tx: block->transactions())
+                confirmed.push_back(tx.hash());
+
+        unconfirmed_short_ids_.remove(confirmed);
+    }
+    else
+    {
+        index_unconfirmed();
+    }
+#endif
+
     set_chain_state(top->validation.state);
     last_block_.store(top);
 
@@ -617,17 +836,33 @@ bool block_chain::start()
     //switch to fast mode if the database is stale
     //set_database_flags();
 
+#ifdef BITPRIM_DB_NEW
+    // Load the header index before chain state, which is populated from it.
+    if ( ! load_header_index()) {
+        return false;
+    }
+#endif // BITPRIM_DB_NEW
+
+#if defined(BITPRIM_DB_TRANSACTION_UNCONFIRMED) || defined(BITPRIM_DB_NEW_FULL)
+    index_unconfirmed();
+#endif
+
     // Initialize chain state after database start but before organizers.
     pool_state_ = chain_state_populator_.populate();
 
-    return pool_state_ && transaction_organizer_.start() &&
-        block_organizer_.start();
+    return pool_state_ && notifier_.start() &&
+        transaction_organizer_.start() && block_organizer_.start() &&
+        organize_queue_.start();
 }
 
 bool block_chain::stop()
 {
     stopped_ = true;
 
+    // Queued items are completed as stopped, the organizing one finishes.
+    // This must precede the critical section, which that one may hold.
+    organize_queue_.stop();
+
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
     validation_mutex_.lock_high_priority();
@@ -640,7 +875,12 @@ bool block_chain::stop()
 
     validation_mutex_.unlock_high_priority();
     ///////////////////////////////////////////////////////////////////////////
-    return result;
+
+    // Batch queries in progress complete on their calling threads.
+    query_pool_.shutdown();
+
+    // Subscribers are sent service_stopped outside of the critical section.
+    return notifier_.stop() && result;
 }
 
 // Close is idempotent and thread safe.
@@ -649,6 +889,19 @@ bool block_chain::close()
 {
     auto const result = stop();
     priority_pool_.join();
+    query_pool_.join();
+
+#ifdef BITPRIM_DB_NEW
+    // Cleared once saved, so repeated closes do not overwrite the snapshot.
+    if (header_index_.size() != 0) {
+        if ( ! header_index_.save(header_index_file_)) {
+            LOG_WARNING(LOG_BLOCKCHAIN) << "Failed to save the header index snapshot.";
+        }
+
+        header_index_.clear();
+    }
+#endif // BITPRIM_DB_NEW
+
     return result && database_.close();
 }
 
@@ -685,6 +938,18 @@ void block_chain::fetch_block(size_t height, bool witness,
         return;
     }
 
+    // Then the recently connected and served blocks.
+    auto const recent = use_block_cache(witness) ? block_cache_.get(height) : nullptr;
+
+    if (recent)
+    {
+        handler(error::success, recent, height);
+        return;
+    }
+
+    // Taken before the store read, a reorganization since discards the fill.
+    auto const generation = block_cache_.generation();
+
     auto const block_result = database_.blocks().get(height);
 
     if (!block_result)
@@ -717,6 +982,10 @@ void block_chain::fetch_block(size_t height, bool witness,
 
     auto message = std::make_shared<const block>(block_result.header(),
         std::move(txs));
+
+    if (use_block_cache(witness))
+        block_cache_.add(message, height, generation);
+
     handler(error::success, message, height);
 }
 
@@ -741,6 +1010,19 @@ void block_chain::fetch_block(hash_digest const& hash, bool witness,
         return;
     }
 
+    // Then the recently connected and served blocks.
+    size_t recent_height;
+    auto const recent = use_block_cache(witness) ? block_cache_.get(hash, recent_height) : nullptr;
+
+    if (recent)
+    {
+        handler(error::success, recent, recent_height);
+        return;
+    }
+
+    // Taken before the store read, a reorganization since discards the fill.
+    auto const generation = block_cache_.generation();
+
     auto const block_result = database_.blocks().get(hash);
 
     if (!block_result)
@@ -773,6 +1055,10 @@ void block_chain::fetch_block(hash_digest const& hash, bool witness,
 
     auto const message = std::make_shared<const block>(block_result.header(),
         std::move(txs));
+
+    if (use_block_cache(witness))
+        block_cache_.add(message, height, generation);
+
     handler(error::success, message, height);
 }
 
@@ -908,8 +1194,37 @@ void block_chain::fetch_merkle_block(hash_digest const& hash,
 }
 
 void block_chain::fetch_compact_block(size_t height, compact_block_fetch_handler handler) const {
-    // TODO (Mario): implement compact blocks.
-    handler(error::not_implemented, {}, 0);
+#ifdef BITPRIM_CURRENCY_BCH
+    bool witness = false;
+#else
+    bool witness = true;
+#endif
+    if (stopped()) {
+        handler(error::service_stopped, {},0);
+        return;
+    }
+
+    // Recent blocks were compacted when connected.
+    auto const cached = compact_block_cache_.get(height);
+
+    if (cached) {
+        handler(error::success, cached, height);
+        return;
+    }
+
+    // Taken before the store read, a reorganization since discards the fill.
+    auto const generation = compact_block_cache_.generation();
+
+    fetch_block(height, witness, [this, handler, witness, generation](const code& ec, block_const_ptr message, size_t height) {
+        if (ec == error::success) {
+            // The pool state at connect time is lost, only the coinbase is prefilled.
+            auto const blk_ptr = compact_block_cache::create(*message, {}, witness);
+            compact_block_cache_.add(blk_ptr, height, generation);
+            handler(error::success, blk_ptr, height);
+        } else {
+            handler(ec, nullptr, height);
+        }
+    });
 }
 
 void block_chain::fetch_compact_block(hash_digest const& hash, compact_block_fetch_handler handler) const {
@@ -922,10 +1237,24 @@ void block_chain::fetch_compact_block(hash_digest const& hash, compact_block_fet
         handler(error::service_stopped, {},0);
         return;
     }
-    
-    fetch_block(hash, witness,[&handler](const code& ec, block_const_ptr message, size_t height) {
+
+    // Recent blocks were compacted when connected.
+    size_t cached_height;
+    auto const cached = compact_block_cache_.get(hash, cached_height);
+
+    if (cached) {
+        handler(error::success, cached, cached_height);
+        return;
+    }
+
+    // Taken before the store read, a reorganization since discards the fill.
+    auto const generation = compact_block_cache_.generation();
+
+    fetch_block(hash, witness, [this, handler, witness, generation](const code& ec, block_const_ptr message, size_t height) {
         if (ec == error::success) {
-            auto blk_ptr = std::make_shared<compact_block>(compact_block::factory_from_block(*message));
+            // The pool state at connect time is lost, only the coinbase is prefilled.
+            auto const blk_ptr = compact_block_cache::create(*message, {}, witness);
+            compact_block_cache_.add(blk_ptr, height, generation);
             handler(error::success, blk_ptr, height);
         } else {
             handler(ec, nullptr, height);
@@ -1041,6 +1370,18 @@ void block_chain::fetch_block(size_t height, bool witness,
         return;
     }
 
+    // Then the recently connected and served blocks.
+    auto const recent = use_block_cache(witness) ? block_cache_.get(height) : nullptr;
+
+    if (recent)
+    {
+        handler(error::success, recent, height);
+        return;
+    }
+
+    // Taken before the store read, a reorganization since discards the fill.
+    auto const generation = block_cache_.generation();
+
     auto const block_result = database_.internal_db().get_block(height);
 
     if (!block_result.is_valid())
@@ -1051,6 +1392,9 @@ void block_chain::fetch_block(size_t height, bool witness,
 
     auto const result = std::make_shared<const block>(block_result);
 
+    if (use_block_cache(witness))
+        block_cache_.add(result, height, generation);
+
     handler(error::success, result, height);
 }
 
@@ -1075,6 +1419,19 @@ void block_chain::fetch_block(hash_digest const& hash, bool witness,
         return;
     }
 
+    // Then the recently connected and served blocks.
+    size_t recent_height;
+    auto const recent = use_block_cache(witness) ? block_cache_.get(hash, recent_height) : nullptr;
+
+    if (recent)
+    {
+        handler(error::success, recent, recent_height);
+        return;
+    }
+
+    // Taken before the store read, a reorganization since discards the fill.
+    auto const generation = block_cache_.generation();
+
     auto const block_result = database_.internal_db().get_block(hash);
 
     if (!block_result.first.is_valid())
@@ -1087,10 +1444,85 @@ void block_chain::fetch_block(hash_digest const& hash, bool witness,
 
     auto const result = std::make_shared<const block>(block_result.first);
 
+    if (use_block_cache(witness))
+        block_cache_.add(result, height, generation);
+
     handler(error::success, result, height);
 }
 #endif 
 
+// The wire form is serialized once per cached block and shared.
+void block_chain::fetch_block_data(size_t height,
+    block_data_fetch_handler handler) const
+{
+    if (stopped())
+    {
+        handler(error::service_stopped, nullptr, 0);
+        return;
+    }
+
+    auto const cached = block_cache_.get_data(height);
+
+    if (cached)
+    {
+        handler(error::success, cached, height);
+        return;
+    }
+
+    // A miss fetches (and caches) the block, then serializes once.
+    auto const serialize = [this, handler](const code& ec,
+        block_const_ptr block, size_t height)
+    {
+        if (ec)
+        {
+            handler(ec, nullptr, 0);
+            return;
+        }
+
+        auto const data = block_cache_.get_data(height);
+        handler(error::success, data ? data : std::make_shared<const data_chunk>(
+            block->to_data(message::version::level::canonical)), height);
+    };
+
+    fetch_block(height, true, serialize);
+}
+
+void block_chain::fetch_block_data(hash_digest const& hash,
+    block_data_fetch_handler handler) const
+{
+    if (stopped())
+    {
+        handler(error::service_stopped, nullptr, 0);
+        return;
+    }
+
+    size_t height;
+    auto const cached = block_cache_.get_data(hash, height);
+
+    if (cached)
+    {
+        handler(error::success, cached, height);
+        return;
+    }
+
+    // A miss fetches (and caches) the block, then serializes once.
+    auto const serialize = [this, handler](const code& ec,
+        block_const_ptr block, size_t height)
+    {
+        if (ec)
+        {
+            handler(ec, nullptr, 0);
+            return;
+        }
+
+        auto const data = block_cache_.get_data(height);
+        handler(error::success, data ? data : std::make_shared<const data_chunk>(
+            block->to_data(message::version::level::canonical)), height);
+    };
+
+    fetch_block(hash, true, serialize);
+}
+
 #if defined(BITPRIM_DB_NEW_BLOCKS) || defined(BITPRIM_DB_NEW_FULL)
 void block_chain::fetch_block_header_txs_size(hash_digest const& hash,
     block_header_txs_size_fetch_handler handler) const
@@ -1162,8 +1594,37 @@ void block_chain::fetch_merkle_block(hash_digest const& hash,
 }
 
 void block_chain::fetch_compact_block(size_t height, compact_block_fetch_handler handler) const {
-    // TODO (Mario): implement compact blocks.
-    handler(error::not_implemented, {}, 0);
+#ifdef BITPRIM_CURRENCY_BCH
+    bool witness = false;
+#else
+    bool witness = true;
+#endif
+    if (stopped()) {
+        handler(error::service_stopped, {},0);
+        return;
+    }
+
+    // Recent blocks were compacted when connected.
+    auto const cached = compact_block_cache_.get(height);
+
+    if (cached) {
+        handler(error::success, cached, height);
+        return;
+    }
+
+    // Taken before the store read, a reorganization since discards the fill.
+    auto const generation = compact_block_cache_.generation();
+
+    fetch_block(height, witness, [this, handler, witness, generation](const code& ec, block_const_ptr message, size_t height) {
+        if (ec == error::success) {
+            // The pool state at connect time is lost, only the coinbase is prefilled.
+            auto const blk_ptr = compact_block_cache::create(*message, {}, witness);
+            compact_block_cache_.add(blk_ptr, height, generation);
+            handler(error::success, blk_ptr, height);
+        } else {
+            handler(ec, nullptr, height);
+        }
+    });
 }
 
 void block_chain::fetch_compact_block(hash_digest const& hash, compact_block_fetch_handler handler) const {
@@ -1176,10 +1637,24 @@ void block_chain::fetch_compact_block(hash_digest const& hash, compact_block_fet
         handler(error::service_stopped, {},0);
         return;
     }
-    
-    fetch_block(hash, witness,[&handler](const code& ec, block_const_ptr message, size_t height) {
+
+    // Recent blocks were compacted when connected.
+    size_t cached_height;
+    auto const cached = compact_block_cache_.get(hash, cached_height);
+
+    if (cached) {
+        handler(error::success, cached, cached_height);
+        return;
+    }
+
+    // Taken before the store read, a reorganization since discards the fill.
+    auto const generation = compact_block_cache_.generation();
+
+    fetch_block(hash, witness, [this, handler, witness, generation](const code& ec, block_const_ptr message, size_t height) {
         if (ec == error::success) {
-            auto blk_ptr = std::make_shared<compact_block>(compact_block::factory_from_block(*message));
+            // The pool state at connect time is lost, only the coinbase is prefilled.
+            auto const blk_ptr = compact_block_cache::create(*message, {}, witness);
+            compact_block_cache_.add(blk_ptr, height, generation);
             handler(error::success, blk_ptr, height);
         } else {
             handler(ec, nullptr, height);
@@ -1189,7 +1664,7 @@ void block_chain::fetch_compact_block(hash_digest const& hash, compact_block_fet
 #endif
 
 #if defined(BITPRIM_DB_NEW) || defined(BITPRIM_DB_NEW_BLOCKS) || defined(BITPRIM_DB_NEW_FULL)
-// This may execute over 500 queries.
+// Heights and hashes come from the header index, no block is read.
 void block_chain::fetch_locator_block_hashes(get_blocks_const_ptr locator,
     hash_digest const& threshold, size_t limit,
     inventory_fetch_handler handler) const
@@ -1205,65 +1680,54 @@ void block_chain::fetch_locator_block_hashes(get_blocks_const_ptr locator,
 
     // Find the start block height.
     // If no start block is on our chain we start with block 0.
-    uint32_t start = 0;
+    size_t start = 0;
     for (auto const& hash: locator->start_hashes())
     {
-        auto const result = database_.internal_db().get_block(hash);
-        if (result.first.is_valid())
-        {
-            start = result.second;
+        if (header_index_.get_height(start, hash))
             break;
-        }
     }
 
     // The begin block requested is always one after the start block.
-    auto begin = safe_add(start, uint32_t(1));
+    auto begin = safe_add(start, size_t(1));
 
     // The maximum number of headers returned is 500.
-    auto end = safe_add(begin, uint32_t(limit));
+    auto end = safe_add(begin, limit);
 
     // Find the upper threshold block height (peer-specified).
     if (locator->stop_hash() != null_hash)
     {
         // If the stop block is not on chain we treat it as a null stop.
-        auto const result = database_.internal_db().get_block(locator->stop_hash());
+        size_t stop;
 
         // Otherwise limit the end height to the stop block height.
         // If end precedes begin floor_subtract will handle below.
-        if (result.first.is_valid())
-            end = std::min(result.second, end);
+        if (header_index_.get_height(stop, locator->stop_hash()))
+            end = std::min(stop, end);
     }
 
     // Find the lower threshold block height (self-specified).
     if (threshold != null_hash)
     {
         // If the threshold is not on chain we ignore it.
-        auto const result = database_.internal_db().get_block(threshold);
+        size_t lower;
 
         // Otherwise limit the begin height to the threshold block height.
         // If begin exceeds end floor_subtract will handle below.
-        if (result.first.is_valid())
-            begin = std::max(result.second, begin);
+        if (header_index_.get_height(lower, threshold))
+            begin = std::max(lower, begin);
     }
 
-    auto hashes = std::make_shared<inventory>();
-    hashes->inventories().reserve(floor_subtract(end, begin));
+    // Copy the hash range until we hit end or the blockchain top.
+    hash_list range;
+    range.reserve(floor_subtract(end, begin));
+    header_index_.get_hashes(range, begin, end);
 
-    // Build the hash list until we hit end or the blockchain top.
-    for (auto height = begin; height < end; ++height)
-    {
-        auto const result = database_.internal_db().get_block(height);
+    auto hashes = std::make_shared<inventory>();
+    hashes->inventories().reserve(range.size());
 
-        // If not found then we are at our top.
-        if (!result.is_valid())
-        {
-            hashes->inventories().shrink_to_fit();
-            break;
-        }
-
-        static auto const id = inventory::type_id::block;
-        hashes->inventories().emplace_back(id, result.header().hash());
-    }
+    static auto const id = inventory::type_id::block;
+    for (auto const& hash: range)
+        hashes->inventories().emplace_back(id, hash);
 
     handler(error::success, std::move(hashes));
 }
@@ -1545,99 +2009,6 @@ std::vector<chain::transaction> block_chain::get_mempool_transactions_from_walle
     return ret;
 }
 
-void block_chain::fill_tx_list_from_mempool(message::compact_block const& block, size_t& mempool_count, std::vector<chain::transaction>& txn_available, std::unordered_map<uint64_t, uint16_t> const& shorttxids) const {
-    
-    std::vector<bool> have_txn(txn_available.size());
-    
-    auto header_hash = hash(block);
-    auto k0 = from_little_endian_unsafe<uint64_t>(header_hash.begin());
-    auto k1 = from_little_endian_unsafe<uint64_t>(header_hash.begin() + sizeof(uint64_t));
-
-    auto const result = database_.internal_db().get_all_transaction_unconfirmed();
-
-    for (auto const& tx_res : result) { 
-        auto const& tx = tx_res.transaction();
-
-#ifdef BITPRIM_CURRENCY_BCH
-        bool witness = false;
-#else
-        bool witness = true;
-#endif
-        uint64_t shortid = sip_hash_uint256(k0, k1, tx.hash(witness)) & uint64_t(0xffffffffffff);
-        
-        auto idit = shorttxids.find(shortid);
-        if (idit != shorttxids.end()) {
-            if (!have_txn[idit->second]) {
-                txn_available[idit->second] = tx;
-                have_txn[idit->second] = true;
-                ++mempool_count;
-            } else {
-                // If we find two mempool txn that match the short id, just
-                // request it. This should be rare enough that the extra
-                // bandwidth doesn't matter, but eating a round-trip due to
-                // FillBlock failure would be annoying.
-                if (txn_available[idit->second].is_valid()) {
-                    //txn_available[idit->second].reset();
-                    txn_available[idit->second] = chain::transaction{};
-                    --mempool_count;
-                }
-            }
-        }
-
-        //TODO (Mario) :  break the loop
-        // Though ideally we'd continue scanning for the
-        // two-txn-match-shortid case, the performance win of an early exit
-        // here is too good to pass up and worth the extra risk.
-        /*if (mempool_count == shorttxids.size()) {
-            return false;
-        } else {
-            return true;
-        }*/
-    }
-
-}
-
-safe_chain::mempool_mini_hash_map block_chain::get_mempool_mini_hash_map(message::compact_block const& block) const {
-#ifdef BITPRIM_CURRENCY_BCH
-     bool witness = false;
-#else
-     bool witness = true;
-#endif
-
-    if (stopped()) {
-        return safe_chain::mempool_mini_hash_map();
-    }
-    
-    auto header_hash = hash(block);
-
-    auto k0 = from_little_endian_unsafe<uint64_t>(header_hash.begin());
-    auto k1 = from_little_endian_unsafe<uint64_t>(header_hash.begin() + sizeof(uint64_t));
-
-    safe_chain::mempool_mini_hash_map mempool;
-
-
-    auto const result = database_.internal_db().get_all_transaction_unconfirmed();
-
-    for (auto const& tx_res : result) { 
-        auto const& tx = tx_res.transaction();
-
-        auto sh = sip_hash_uint256(k0, k1, tx.hash(witness));
-        
-       /* to_little_endian()
-        uint64_t pepe = 4564564;
-        uint64_t pepe2 = pepe & 0x0000ffffffffffff;
-            
-        reinterpret_cast<uint8_t*>(pepe2);
-        */
-        //Drop the most significative bytes from the sh
-        mini_hash short_id;
-        mempool.emplace(short_id,tx);
-    
-    }
-
-    return mempool;
-}
-
 std::vector<libbitcoin::blockchain::mempool_transaction_summary> block_chain::get_mempool_transactions(std::string const& payment_address, bool use_testnet_rules, bool witness) const{
     std::vector<std::string> addresses = {payment_address};
     return get_mempool_transactions(addresses, use_testnet_rules, witness);
@@ -1823,99 +2194,6 @@ std::vector<chain::transaction> block_chain::get_mempool_transactions_from_walle
 */
 
 
-void block_chain::fill_tx_list_from_mempool(message::compact_block const& block, size_t& mempool_count, std::vector<chain::transaction>& txn_available, std::unordered_map<uint64_t, uint16_t> const& shorttxids) const {
-    
-    std::vector<bool> have_txn(txn_available.size());
-    
-    auto header_hash = hash(block);
-    auto k0 = from_little_endian_unsafe<uint64_t>(header_hash.begin());
-    auto k1 = from_little_endian_unsafe<uint64_t>(header_hash.begin() + sizeof(uint64_t));
-
-        
-    //LOG_INFO(LOG_BLOCKCHAIN)
-    //<< "fill_tx_list_from_mempool header_hash ->  " << encode_hash(header_hash) 
-    //<< " k0 " << k0
-    //<< " k1 " << k1;
-            
-
-    database_.transactions_unconfirmed().for_each([&](chain::transaction const &tx) {
-#ifdef BITPRIM_CURRENCY_BCH
-        bool witness = false;
-#else
-        bool witness = true;
-#endif
-        uint64_t shortid = sip_hash_uint256(k0, k1, tx.hash(witness)) & uint64_t(0xffffffffffff);
-        
-      /*   LOG_INFO(LOG_BLOCKCHAIN)
-            << "mempool tx ->  " << encode_hash(tx.hash()) 
-            << " shortid " << shortid;
-      */      
-        auto idit = shorttxids.find(shortid);
-        if (idit != shorttxids.end()) {
-            if (!have_txn[idit->second]) {
-                txn_available[idit->second] = tx;
-                have_txn[idit->second] = true;
-                ++mempool_count;
-            } else {
-                // If we find two mempool txn that match the short id, just
-                // request it. This should be rare enough that the extra
-                // bandwidth doesn't matter, but eating a round-trip due to
-                // FillBlock failure would be annoying.
-                if (txn_available[idit->second].is_valid()) {
-                    //txn_available[idit->second].reset();
-                    txn_available[idit->second] = chain::transaction{};
-                    --mempool_count;
-                }
-            }
-        }
-        // Though ideally we'd continue scanning for the
-        // two-txn-match-shortid case, the performance win of an early exit
-        // here is too good to pass up and worth the extra risk.
-        if (mempool_count == shorttxids.size()) {
-            return false;
-        } else {
-            return true;
-        }
-    });
-}
-
-safe_chain::mempool_mini_hash_map block_chain::get_mempool_mini_hash_map(message::compact_block const& block) const {
-#ifdef BITPRIM_CURRENCY_BCH
-     bool witness = false;
-#else
-     bool witness = true;
-#endif
-
-    if (stopped()) {
-        return safe_chain::mempool_mini_hash_map();
-    }
-    
-    auto header_hash = hash(block);
-
-    auto k0 = from_little_endian_unsafe<uint64_t>(header_hash.begin());
-    auto k1 = from_little_endian_unsafe<uint64_t>(header_hash.begin() + sizeof(uint64_t));
-
-    safe_chain::mempool_mini_hash_map mempool;
-   
-    database_.transactions_unconfirmed().for_each([&](chain::transaction const &tx) {
-    
-        auto sh = sip_hash_uint256(k0, k1, tx.hash(witness));
-        
-       /* to_little_endian()
-        uint64_t pepe = 4564564;
-        uint64_t pepe2 = pepe & 0x0000ffffffffffff;
-            
-        reinterpret_cast<uint8_t*>(pepe2);
-        */
-        //Drop the most significative bytes from the sh
-        mini_hash short_id;
-        mempool.emplace(short_id,tx);
-        return true;
-    });
-
-    return mempool;
-}
-
 std::vector<libbitcoin::blockchain::mempool_transaction_summary> block_chain::get_mempool_transactions(std::string const& payment_address, bool use_testnet_rules, bool witness) const{
     std::vector<std::string> addresses = {payment_address};
     return get_mempool_transactions(addresses, use_testnet_rules, witness);
@@ -1946,6 +2224,132 @@ void block_chain::fetch_unconfirmed_transaction(hash_digest const& hash, transac
 
 #endif // BITPRIM_DB_TRANSACTION_UNCONFIRMED
 
+#if defined(BITPRIM_DB_TRANSACTION_UNCONFIRMED) || defined(BITPRIM_DB_NEW_FULL)
+
+// Compact block reconstruction.
+//-----------------------------------------------------------------------------
+// Short ids are computed over the contiguous hash array of the unconfirmed
+// pool, transactions are read from the store only for the matches.
+
+void block_chain::index_unconfirmed()
+{
+#ifdef BITPRIM_CURRENCY_BCH
+    static constexpr bool witness = false;
+#else
+    static constexpr bool witness = true;
+#endif
+
+    hash_list hashes;
+    hash_list txids;
+
+#ifdef BITPRIM_DB_NEW_FULL
+    for (auto const& result: database_.internal_db().get_all_transaction_unconfirmed())
+    {
+        hashes.push_back(result.transaction().hash(witness));
+        txids.push_back(result.transaction().hash());
+    }
+#else
+    database_.transactions_unconfirmed().for_each([&](chain::transaction const& tx)
+    {
+        hashes.push_back(tx.hash(witness));
+        txids.push_back(tx.hash());
+        return true;
+    });
+#endif
+
+    unconfirmed_short_ids_.reset(hashes, txids);
+}
+
+bool block_chain::get_unconfirmed(chain::transaction& out_transaction,
+    hash_digest const& txid) const
+{
+#ifdef BITPRIM_DB_NEW_FULL
+    auto const result = database_.internal_db().get_transaction_unconfirmed(txid);
+
+    if ( ! result.is_valid())
+        return false;
+#else
+    auto const result = database_.transactions_unconfirmed().get(txid);
+
+    if ( ! result)
+        return false;
+#endif
+
+    out_transaction = result.transaction();
+    return true;
+}
+
+void block_chain::fill_tx_list_from_mempool(message::compact_block const& block, size_t& mempool_count, std::vector<chain::transaction>& txn_available, std::unordered_map<uint64_t, uint16_t> const& shorttxids) const {
+    std::vector<bool> have_txn(txn_available.size());
+
+    auto const header_hash = hash(block);
+    auto const k0 = from_little_endian_unsafe<uint64_t>(header_hash.begin());
+    auto const k1 = from_little_endian_unsafe<uint64_t>(header_hash.begin() + sizeof(uint64_t));
+
+    short_id_index::short_id_list short_ids;
+    hash_list txids;
+    unconfirmed_short_ids_.short_ids(k0, k1, dispatch_, short_ids, txids);
+
+    for (size_t index = 0; index < short_ids.size(); ++index) {
+        auto idit = shorttxids.find(short_ids[index]);
+        if (idit == shorttxids.end()) {
+            continue;
+        }
+
+        if ( ! have_txn[idit->second]) {
+            // The pool may have dropped the tx since it was indexed.
+            if (get_unconfirmed(txn_available[idit->second], txids[index])) {
+                have_txn[idit->second] = true;
+                ++mempool_count;
+            }
+        } else {
+            // If we find two mempool txn that match the short id, just
+            // request it. This should be rare enough that the extra
+            // bandwidth doesn't matter, but eating a round-trip due to
+            // FillBlock failure would be annoying.
+            if (txn_available[idit->second].is_valid()) {
+                txn_available[idit->second] = chain::transaction{};
+                --mempool_count;
+            }
+        }
+    }
+}
+
+safe_chain::mempool_mini_hash_map block_chain::get_mempool_mini_hash_map(message::compact_block const& block) const {
+    if (stopped()) {
+        return safe_chain::mempool_mini_hash_map();
+    }
+
+    auto const header_hash = hash(block);
+    auto const k0 = from_little_endian_unsafe<uint64_t>(header_hash.begin());
+    auto const k1 = from_little_endian_unsafe<uint64_t>(header_hash.begin() + sizeof(uint64_t));
+
+    short_id_index::short_id_list short_ids;
+    hash_list txids;
+    unconfirmed_short_ids_.short_ids(k0, k1, dispatch_, short_ids, txids);
+
+    safe_chain::mempool_mini_hash_map mempool;
+    mempool.reserve(short_ids.size());
+
+    for (size_t index = 0; index < short_ids.size(); ++index) {
+        chain::transaction tx;
+
+        if ( ! get_unconfirmed(tx, txids[index])) {
+            continue;
+        }
+
+        // The short id is the low six bytes of the hash, little endian.
+        auto const bytes = to_little_endian(short_ids[index]);
+        mini_hash short_id;
+        std::copy_n(bytes.begin(), short_id.size(), short_id.begin());
+        mempool.emplace(short_id, std::move(tx));
+    }
+
+    return mempool;
+}
+
+#endif // defined(BITPRIM_DB_TRANSACTION_UNCONFIRMED) || defined(BITPRIM_DB_NEW_FULL)
+
 #ifdef BITPRIM_DB_LEGACY
 // This is same as fetch_transaction but skips deserializing the tx payload.
 void block_chain::fetch_transaction_position(hash_digest const& hash,
@@ -2266,7 +2670,7 @@ void block_chain::fetch_last_height(last_height_fetch_handler handler) const
 
 
 
-// This may execute over 2000 queries.
+// Heights are resolved in the header index, this may execute 2000 queries.
 void block_chain::fetch_locator_block_headers(get_headers_const_ptr locator, hash_digest const& threshold, size_t limit, locator_block_headers_fetch_handler handler) const {
     if (stopped()) {
         handler(error::service_stopped, nullptr);
@@ -2280,9 +2684,7 @@ void block_chain::fetch_locator_block_headers(get_headers_const_ptr locator, has
     // If no start block is on our chain we start with block 0.
     size_t start = 0;
     for (auto const& hash: locator->start_hashes()) {
-        auto const result = database_.internal_db().get_header(hash);
-        if (result.first.is_valid()) {
-            start = result.second; //result.height();
+        if (header_index_.get_height(start, hash)) {
             break;
         }
     }
@@ -2296,26 +2698,24 @@ void block_chain::fetch_locator_block_headers(get_headers_const_ptr locator, has
     // Find the upper threshold block height (peer-specified).
     if (locator->stop_hash() != null_hash) {
         // If the stop block is not on chain we treat it as a null stop.
-        auto const result = database_.internal_db().get_header(locator->stop_hash());
+        size_t stop;
 
         // Otherwise limit the end height to the stop block height.
         // If end precedes begin floor_subtract will handle below.
-        if (result.first.is_valid()) {
-            // end = std::min(result.height(), end);
-            end = std::min(size_t(result.second), end);
+        if (header_index_.get_height(stop, locator->stop_hash())) {
+            end = std::min(stop, end);
         }
     }
 
     // Find the lower threshold block height (self-specified).
     if (threshold != null_hash) {
         // If the threshold is not on chain we ignore it.
-        auto const result = database_.internal_db().get_header(threshold);
+        size_t lower;
 
         // Otherwise limit the begin height to the threshold block height.
         // If begin exceeds end floor_subtract will handle below.
-        if (result.first.is_valid()) {
-            // begin = std::max(result.height(), begin);
-            begin = std::max(size_t(result.second), begin);
+        if (header_index_.get_height(lower, threshold)) {
+            begin = std::max(lower, begin);
         }
     }
 
@@ -2324,6 +2724,15 @@ void block_chain::fetch_locator_block_headers(get_headers_const_ptr locator, has
 
     // Build the hash list until we hit end or the blockchain top.
     for (auto height = begin; height < end; ++height) {
+        // Recent headers are served from the block cache when present, the
+        // peek does not count or reorder, many heights are read here.
+        auto const recent = block_cache_.peek(height);
+
+        if (recent) {
+            message->elements().push_back(recent->header());
+            continue;
+        }
+
         auto const result = database_.internal_db().get_header(height);
 
         // If not found then we are at our top.
@@ -2336,7 +2745,7 @@ void block_chain::fetch_locator_block_headers(get_headers_const_ptr locator, has
     handler(error::success, std::move(message));
 }
 
-// This may generally execute 29+ queries.
+// The hashes are read from the header index under a single lock.
 void block_chain::fetch_block_locator(block::indexes const& heights, block_locator_fetch_handler handler) const {
     
     if (stopped()) {
@@ -2346,16 +2755,10 @@ void block_chain::fetch_block_locator(block::indexes const& heights, block_locat
 
     // Caller can cast get_headers down to get_blocks.
     auto message = std::make_shared<get_headers>();
-    auto& hashes = message->start_hashes();
-    hashes.reserve(heights.size());
 
-    for (auto const height : heights) {
-        auto const result = database_.internal_db().get_header(height);
-        if ( ! result.is_valid()) {
-            handler(error::not_found, nullptr);
-            break;
-        }
-        hashes.push_back(result.hash());
+    if ( ! header_index_.get_locator(message->start_hashes(), heights)) {
+        handler(error::not_found, nullptr);
+        return;
     }
 
     handler(error::success, message);
@@ -2527,16 +2930,26 @@ void block_chain::filter_transactions(get_data_ptr message, result_handler handl
     }
 
 #elif defined(BITPRIM_WITH_MEMPOOL)
-    auto validated_txs = mempool_.get_validated_txs_low();
+    hash_list tx_hashes;
+    tx_hashes.reserve(inventories.size());
+
+    for (auto const& inventory : inventories) {
+        if (inventory.is_transaction_type()) {
+            tx_hashes.push_back(inventory.hash());
+        }
+    }
 
-    if (validated_txs.empty()) {
+    if (tx_hashes.empty()) {
         handler(error::success);
         return;    
     }
 
+    // Single lookup job, the mempool index is never copied.
+    auto const found = mempool_.contains(tx_hashes);
+    size_t index = 0;
+
     for (auto it = inventories.begin(); it != inventories.end();) {
-        auto found = validated_txs.find(it->hash());
-        if (it->is_transaction_type() && found != validated_txs.end()) {
+        if (it->is_transaction_type() && found[index++]) {
             it = inventories.erase(it);
         } else {
             ++it;
@@ -2602,19 +3015,31 @@ void block_chain::transaction_validate(transaction_const_ptr tx, result_handler
     transaction_organizer_.transaction_validate(tx, handler);
 }
 
+// Block Validation.
+//-----------------------------------------------------------------------------
+
+void block_chain::validate_proposal(block_const_ptr block, proposal_validation_handler handler) const {
+    block_organizer_.validate_proposal(block, handler);
+}
+
+size_t block_chain::add_assume_valid_headers(const chain::header::list& headers) {
+    return assume_valid_.add(headers);
+}
+
 // Organizers.
 //-----------------------------------------------------------------------------
 
+// The caller returns once queued, validation does not park network threads.
 void block_chain::organize(block_const_ptr block, result_handler handler)
 {
     // This cannot call organize or stop (lock safe).
-    block_organizer_.organize(block, handler);
+    organize_queue_.organize(block, handler);
 }
 
 void block_chain::organize(transaction_const_ptr tx, result_handler handler)
 {
     // This cannot call organize or stop (lock safe).
-    transaction_organizer_.organize(tx, handler);
+    organize_queue_.organize(tx, handler);
 }
 
 
@@ -2626,6 +3051,10 @@ bool block_chain::is_stale_fast() const {
     return is_stale();
 }
 
+bool block_chain::is_assumed_valid(const hash_digest& block_hash) const {
+    return assume_valid_.contains(block_hash);
+}
+
 bool block_chain::is_stale() const {
     // If there is no limit set the chain is never considered stale.
     if (notify_limit_seconds_ == 0) {
@@ -2655,6 +3084,21 @@ const settings& block_chain::chain_settings() const
     return settings_;
 }
 
+const script_cache& block_chain::script_verification_cache() const
+{
+    return script_cache_;
+}
+
+const block_cache& block_chain::recent_block_cache() const
+{
+    return block_cache_;
+}
+
+organize_queue& block_chain::organizer_queue()
+{
+    return organize_queue_;
+}
+
 // protected
 bool block_chain::stopped() const
 {
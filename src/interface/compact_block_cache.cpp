@@ -0,0 +1,206 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/interface/compact_block_cache.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+
+#ifdef BITPRIM_USE_DOMAIN
+#include <bitcoin/infrastructure/math/sip_hash.hpp>
+#else
+#include <bitcoin/bitcoin/math/sip_hash.hpp>
+#endif // BITPRIM_USE_DOMAIN
+
+namespace libbitcoin {
+namespace blockchain {
+
+using namespace bc::message;
+
+// BIP152 short ids are the low six bytes of the SipHash.
+static constexpr uint64_t short_id_mask = 0xffffffffffff;
+
+compact_block_cache::compact_block_cache(size_t capacity)
+    : capacity_(capacity)
+    , generation_(0)
+{}
+
+// static
+compact_block_ptr compact_block_cache::create(message::block const& block,
+    std::vector<bool> const& pooled, bool witness) {
+    auto const& txs = block.transactions();
+
+    // The SipHash key commits to the header and a per block nonce.
+    auto const nonce = pseudo_random::next();
+    compact_block const keyed(block.header(), nonce, {}, {});
+    auto const key = hash(keyed);
+    auto const k0 = from_little_endian_unsafe<uint64_t>(key.begin());
+    auto const k1 = from_little_endian_unsafe<uint64_t>(key.begin() + sizeof(uint64_t));
+
+    compact_block::short_id_list short_ids;
+    prefilled_transaction::list prefilled;
+    short_ids.reserve(txs.empty() ? 0 : txs.size() - 1);
+
+    for (size_t index = 0; index < txs.size(); ++index) {
+        // The coinbase is never pooled, unpooled txs would cost a round trip.
+        auto const is_pooled = index != 0 && index < pooled.size() && pooled[index];
+
+        if (index == 0 || ( ! pooled.empty() && ! is_pooled)) {
+            prefilled.emplace_back(index, txs[index]);
+        } else {
+            short_ids.push_back(sip_hash_uint256(k0, k1, txs[index].hash(witness)) & short_id_mask);
+        }
+    }
+
+    return std::make_shared<compact_block>(chain::header(block.header()),
+        nonce, std::move(short_ids), std::move(prefilled));
+}
+
+bool compact_block_cache::enabled() const {
+    return capacity_ != 0;
+}
+
+// private, call under lock.
+void compact_block_cache::erase(std::map<size_t, compact_block_ptr>::iterator it) {
+    heights_.erase(it->second->header().hash());
+    by_height_.erase(it);
+}
+
+// private, call under lock.
+void compact_block_cache::insert(compact_block_ptr block, size_t height) {
+    auto const existing = by_height_.find(height);
+    if (existing != by_height_.end()) {
+        erase(existing);
+    }
+
+    // An older block than all cached ones would be evicted right away.
+    if (by_height_.size() == capacity_) {
+        if (height < by_height_.begin()->first) {
+            return;
+        }
+
+        erase(by_height_.begin());
+    }
+
+    heights_[block->header().hash()] = height;
+    by_height_.emplace(height, block);
+}
+
+void compact_block_cache::add(compact_block_ptr block, size_t height) {
+    if ( ! enabled() || ! block) {
+        return;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+    insert(block, height);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void compact_block_cache::add(compact_block_ptr block, size_t height, size_t generation) {
+    if ( ! enabled() || ! block) {
+        return;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    // The block may have been read from a chain since reorganized.
+    if (generation != generation_) {
+        return;
+    }
+
+    insert(block, height);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void compact_block_cache::remove_above(size_t height) {
+    if ( ! enabled()) {
+        return;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+    ++generation_;
+
+    while ( ! by_height_.empty() && std::prev(by_height_.end())->first > height) {
+        erase(std::prev(by_height_.end()));
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+compact_block_ptr compact_block_cache::get(hash_digest const& hash, size_t& out_height) const {
+    if ( ! enabled()) {
+        return nullptr;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    auto const it = heights_.find(hash);
+    if (it == heights_.end()) {
+        return nullptr;
+    }
+
+    out_height = it->second;
+    return by_height_.at(it->second);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+compact_block_ptr compact_block_cache::get(size_t height) const {
+    if ( ! enabled()) {
+        return nullptr;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    auto const it = by_height_.find(height);
+    return it == by_height_.end() ? nullptr : it->second;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Properties.
+//-----------------------------------------------------------------------------
+
+size_t compact_block_cache::capacity() const {
+    return capacity_;
+}
+
+size_t compact_block_cache::generation() const {
+    shared_lock lock(mutex_);
+    return generation_;
+}
+
+size_t compact_block_cache::count() const {
+    shared_lock lock(mutex_);
+    return by_height_.size();
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
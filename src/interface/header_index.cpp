@@ -0,0 +1,343 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/interface/header_index.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <boost/filesystem.hpp>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+static_assert(sizeof(header_index::record) == 16, "header_index::record is not packed");
+
+void header_index::clear() {
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    records_.clear();
+    hashes_.clear();
+    work_.clear();
+    heights_.clear();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void header_index::reserve(size_t size) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    records_.reserve(size);
+    hashes_.reserve(size);
+    work_.reserve(size);
+    heights_.reserve(size);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private, call under lock.
+uint32_t header_index::median_time_past(uint32_t timestamp) const {
+    std::array<uint32_t, median_time_past_interval> times;
+    auto const previous = std::min(records_.size(), median_time_past_interval - 1);
+
+    auto out = std::transform(records_.end() - previous, records_.end(), times.begin(), [](record const& x) {
+        return x.timestamp;
+    });
+
+    *out++ = timestamp;
+
+    // Same as chain_state, the upper median of an even count.
+    auto const count = static_cast<size_t>(std::distance(times.begin(), out));
+    auto const middle = times.begin() + count / 2;
+    std::nth_element(times.begin(), middle, out);
+    return *middle;
+}
+
+void header_index::push(chain::header const& header) {
+    auto const hash = header.hash();
+    auto const proof = chain::header::proof(header.bits());
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    auto const height = records_.size();
+    BITCOIN_ASSERT(height <= max_uint32);
+
+    records_.push_back({header.bits(), header.timestamp(), header.version(), median_time_past(header.timestamp())});
+    hashes_.push_back(hash);
+    work_.push_back(work_.empty() ? proof : work_.back() + proof);
+    heights_[hash] = static_cast<uint32_t>(height);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void header_index::truncate(size_t height) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    auto const size = std::min(records_.size(), safe_add(height, size_t(1)));
+
+    for (auto index = size; index < hashes_.size(); ++index) {
+        heights_.erase(hashes_[index]);
+    }
+
+    records_.resize(size);
+    hashes_.resize(size);
+    work_.resize(size);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+size_t header_index::size() const {
+    shared_lock lock(mutex_);
+    return records_.size();
+}
+
+bool header_index::top_height(size_t& out_height) const {
+    shared_lock lock(mutex_);
+
+    if (records_.empty()) {
+        return false;
+    }
+
+    out_height = records_.size() - 1;
+    return true;
+}
+
+bool header_index::get_hash(hash_digest& out_hash, size_t height) const {
+    shared_lock lock(mutex_);
+
+    if (height >= hashes_.size()) {
+        return false;
+    }
+
+    out_hash = hashes_[height];
+    return true;
+}
+
+bool header_index::get_height(size_t& out_height, hash_digest const& hash) const {
+    shared_lock lock(mutex_);
+
+    auto const it = heights_.find(hash);
+    if (it == heights_.end()) {
+        return false;
+    }
+
+    out_height = it->second;
+    return true;
+}
+
+void header_index::get_hashes(hash_list& out_hashes, size_t begin, size_t end) const {
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    end = std::min(end, hashes_.size());
+
+    if (begin < end) {
+        out_hashes.insert(out_hashes.end(), hashes_.begin() + begin, hashes_.begin() + end);
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool header_index::get_locator(hash_list& out_hashes, std::vector<size_t> const& heights) const {
+    out_hashes.reserve(out_hashes.size() + heights.size());
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    for (auto const height : heights) {
+        if (height >= hashes_.size()) {
+            return false;
+        }
+
+        out_hashes.push_back(hashes_[height]);
+    }
+
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool header_index::get_record(record& out_record, size_t height) const {
+    shared_lock lock(mutex_);
+
+    if (height >= records_.size()) {
+        return false;
+    }
+
+    out_record = records_[height];
+    return true;
+}
+
+bool header_index::get_bits(uint32_t& out_bits, size_t height) const {
+    record value;
+    if ( ! get_record(value, height)) {
+        return false;
+    }
+
+    out_bits = value.bits;
+    return true;
+}
+
+bool header_index::get_timestamp(uint32_t& out_timestamp, size_t height) const {
+    record value;
+    if ( ! get_record(value, height)) {
+        return false;
+    }
+
+    out_timestamp = value.timestamp;
+    return true;
+}
+
+bool header_index::get_version(uint32_t& out_version, size_t height) const {
+    record value;
+    if ( ! get_record(value, height)) {
+        return false;
+    }
+
+    out_version = value.version;
+    return true;
+}
+
+bool header_index::get_median_time_past(uint32_t& out_median_time_past, size_t height) const {
+    record value;
+    if ( ! get_record(value, height)) {
+        return false;
+    }
+
+    out_median_time_past = value.median_time_past;
+    return true;
+}
+
+bool header_index::get_work(uint256_t& out_work, size_t height) const {
+    shared_lock lock(mutex_);
+
+    if (height >= work_.size()) {
+        return false;
+    }
+
+    out_work = work_[height];
+    return true;
+}
+
+uint256_t header_index::get_work_above(size_t from_height) const {
+    shared_lock lock(mutex_);
+
+    if (from_height >= work_.size()) {
+        return 0;
+    }
+
+    return from_height == 0 ? work_.back() : work_.back() - work_[from_height - 1];
+}
+
+bool header_index::save(boost::filesystem::path const& file) const {
+    bc::ofstream stream(file.string(), std::ios::binary | std::ios::trunc);
+    if ( ! stream.good()) {
+        return false;
+    }
+
+    ostream_writer sink(stream);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    sink.write_4_bytes_little_endian(snapshot_magic);
+    sink.write_4_bytes_little_endian(snapshot_version);
+    sink.write_8_bytes_little_endian(records_.size());
+
+    for (size_t height = 0; height < records_.size(); ++height) {
+        auto const& value = records_[height];
+        sink.write_hash(hashes_[height]);
+        sink.write_4_bytes_little_endian(value.bits);
+        sink.write_4_bytes_little_endian(value.timestamp);
+        sink.write_4_bytes_little_endian(value.version);
+        sink.write_4_bytes_little_endian(value.median_time_past);
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    stream.flush();
+    return sink && stream.good();
+}
+
+bool header_index::load(boost::filesystem::path const& file) {
+    clear();
+
+    bc::ifstream stream(file.string(), std::ios::binary);
+    if ( ! stream.good()) {
+        return false;
+    }
+
+    istream_reader source(stream);
+
+    if (source.read_4_bytes_little_endian() != snapshot_magic ||
+        source.read_4_bytes_little_endian() != snapshot_version) {
+        return false;
+    }
+
+    auto const count = source.read_8_bytes_little_endian();
+    if ( ! source || count > max_uint32) {
+        return false;
+    }
+
+    reserve(count);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    for (size_t height = 0; height < count; ++height) {
+        auto const hash = source.read_hash();
+        record value;
+        value.bits = source.read_4_bytes_little_endian();
+        value.timestamp = source.read_4_bytes_little_endian();
+        value.version = source.read_4_bytes_little_endian();
+        value.median_time_past = source.read_4_bytes_little_endian();
+
+        if ( ! source) {
+            break;
+        }
+
+        // The proof is derived from bits, it is not stored.
+        auto const proof = chain::header::proof(value.bits);
+        work_.push_back(work_.empty() ? proof : work_.back() + proof);
+        records_.push_back(value);
+        hashes_.push_back(hash);
+        heights_[hash] = static_cast<uint32_t>(height);
+    }
+
+    if (records_.size() != count) {
+        records_.clear();
+        hashes_.clear();
+        work_.clear();
+        heights_.clear();
+        return false;
+    }
+
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
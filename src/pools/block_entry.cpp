@@ -27,7 +27,14 @@ namespace libbitcoin {
 namespace blockchain {
 
 block_entry::block_entry(block_const_ptr block)
-  : hash_(block->hash()), block_(block)
+  : hash_(block->hash()), block_(block), proof_(block->proof())
+{
+}
+
+block_entry::block_entry(block_const_ptr block,
+    block_outpoints::const_ptr outpoints)
+  : hash_(block->hash()), block_(block), outpoints_(outpoints),
+    proof_(block->proof())
 {
 }
 
@@ -42,11 +49,23 @@ block_const_ptr block_entry::block() const
     return block_;
 }
 
+// Not valid if the entry is a search key.
+block_outpoints::const_ptr block_entry::outpoints() const
+{
+    return outpoints_;
+}
+
 const hash_digest& block_entry::hash() const
 {
     return hash_;
 }
 
+// Not valid if the entry is a search key.
+const uint256_t& block_entry::proof() const
+{
+    return proof_;
+}
+
 // Not callable if the entry is a search key.
 const hash_digest& block_entry::parent() const
 {
@@ -18,6 +18,7 @@
  */
 #include <bitcoin/blockchain/pools/block_organizer.hpp>
 
+#include <chrono>
 #include <cstddef>
 #include <functional>
 #include <future>
@@ -27,6 +28,7 @@
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
 #include <bitcoin/blockchain/pools/block_pool.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
+#include <bitcoin/blockchain/pools/orphan_pool.hpp>
 #include <bitcoin/blockchain/settings.hpp>
 #include <bitcoin/blockchain/validate/validate_block.hpp>
 
@@ -39,6 +41,12 @@ using namespace std::placeholders;
 
 #define NAME "block_organizer"
 
+// The block is in the chain or the block pool, so children may follow it.
+static bool is_organized(const code& ec) {
+    return ec == error::success || ec == error::insufficient_work ||
+        ec == error::duplicate_block;
+}
+
 // Database access is limited to: push, pop, last-height, branch-work,
 // validator->populator:
 // spend: { spender }
@@ -46,21 +54,25 @@ using namespace std::placeholders;
 // transaction: { exists, height, output }
 
 #if defined(BITPRIM_WITH_MEMPOOL)
-block_organizer::block_organizer(prioritized_mutex& mutex, dispatcher& dispatch, threadpool& thread_pool, fast_chain& chain, const settings& settings, bool relay_transactions, mining::mempool& mp)
+block_organizer::block_organizer(prioritized_mutex& mutex, dispatcher& dispatch, chain_notifier& notifier, fast_chain& chain, const settings& settings, script_cache& cache, bool relay_transactions, mining::mempool& mp)
 #else
-block_organizer::block_organizer(prioritized_mutex& mutex, dispatcher& dispatch, threadpool& thread_pool, fast_chain& chain, const settings& settings, bool relay_transactions)
+block_organizer::block_organizer(prioritized_mutex& mutex, dispatcher& dispatch, chain_notifier& notifier, fast_chain& chain, const settings& settings, script_cache& cache, bool relay_transactions)
 #endif
     : fast_chain_(chain)
     , mutex_(mutex)
     , stopped_(true)
     , dispatch_(dispatch)
+    , settings_(settings)
+    , script_cache_(cache)
+    , relay_transactions_(relay_transactions)
     , block_pool_(settings.reorganization_limit)
+    , orphan_pool_(settings.orphan_pool_size, settings.orphan_pool_count)
 #if defined(BITPRIM_WITH_MEMPOOL)
-    , validator_(dispatch, fast_chain_, settings, relay_transactions, mp)
+    , validator_(dispatch, fast_chain_, settings, cache, relay_transactions, mp)
 #else
-    , validator_(dispatch, fast_chain_, settings, relay_transactions)
+    , validator_(dispatch, fast_chain_, settings, cache, relay_transactions)
 #endif    
-    , subscriber_(std::make_shared<reorganize_subscriber>(thread_pool, NAME))
+    , notifier_(notifier)
 
 #if defined(BITPRIM_WITH_MEMPOOL)
     , mempool_(mp)
@@ -79,16 +91,14 @@ bool block_organizer::stopped() const {
 
 bool block_organizer::start() {
     stopped_ = false;
-    subscriber_->start();
     validator_.start();
     return true;
 }
 
 bool block_organizer::stop() {
     validator_.stop();
-    subscriber_->stop();
-    subscriber_->invoke(error::service_stopped, 0, {}, {});
     stopped_ = true;
+    orphan_pool_.clear();
     return true;
 }
 
@@ -97,14 +107,41 @@ bool block_organizer::stop() {
 
 // This is called from block_chain::organize.
 void block_organizer::organize(block_const_ptr block, result_handler handler) {
+    organize(block, false, handler);
+}
+
+// This is called from the organize queue, which checks the queued blocks
+// concurrently while the preceding ones are accepted, connected and stored.
+void block_organizer::organize_checked(block_const_ptr block, result_handler handler) {
+    organize(block, true, handler);
+}
+
+void block_organizer::check(block_const_ptr block, result_handler handler) const {
+    validator_.check(block, handler);
+}
+
+// private
+void block_organizer::organize(block_const_ptr block, bool checked, result_handler handler) {
+    auto const ec = organize_critical(block, checked);
+
+    // Invoke caller handler outside of critical section.
+    handler(ec);
+
+    // Pooled orphans of the block can now be organized.
+    if ( ! block->validation.simulate && is_organized(ec)) {
+        organize_orphans(block->hash());
+    }
+}
+
+// private
+code block_organizer::organize_critical(block_const_ptr block, bool checked) {
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
     mutex_.lock_high_priority();
 
     if (stopped()) {
         mutex_.unlock_high_priority();
-        handler(error::service_stopped);
-        return;
+        return error::service_stopped;
     }
 
     // Reset the reusable promise.
@@ -113,19 +150,45 @@ void block_organizer::organize(block_const_ptr block, result_handler handler) {
     const result_handler complete = std::bind(&block_organizer::signal_completion, this, _1);
     const auto check_handler = std::bind(&block_organizer::handle_check, this, _1, block, complete);
 
-    // Checks that are independent of chain state.
-    validator_.check(block, check_handler);
+    if (checked) {
+        check_handler(error::success);
+    } else {
+        // Checks that are independent of chain state.
+        validator_.check(block, check_handler);
+    }
 
     // Wait on completion signal.
     // This is necessary in order to continue on a non-priority thread.
     // If we do not wait on the original thread there may be none left.
-    auto ec = resume_.get_future().get();
+    auto const ec = resume_.get_future().get();
 
     mutex_.unlock_high_priority();
     ///////////////////////////////////////////////////////////////////////////
 
-    // Invoke caller handler outside of critical section.
-    handler(ec);
+    return ec;
+}
+
+// private
+// Orphans are organized breadth first, so each follows its parent. They were
+// checked before being pooled, so only acceptance and connection remain.
+void block_organizer::organize_orphans(hash_digest const& parent) {
+    hash_list parents{ parent };
+
+    for (size_t index = 0; index < parents.size() && ! stopped(); ++index) {
+        for (auto const& orphan : orphan_pool_.remove_children(parents[index])) {
+            auto const ec = organize_critical(orphan, true);
+
+            if (is_organized(ec)) {
+                parents.push_back(orphan->hash());
+                continue;
+            }
+
+            // Descendants of a rejected orphan remain pooled until evicted.
+            LOG_DEBUG(LOG_BLOCKCHAIN)
+                << "Pooled orphan block [" << encode_hash(orphan->hash())
+                << "] not organized: " << ec.message();
+        }
+    }
 }
 
 // private
@@ -167,6 +230,11 @@ void block_organizer::handle_check(const code& ec, block_const_ptr block, result
     }
 
     if ( ! set_branch_height(branch)) {
+        // Keep the checked block until its parent is organized.
+        if ( ! block->validation.simulate) {
+            orphan_pool_.add(block);
+        }
+
         handler(error::orphan_block);
         return;
     }
@@ -196,6 +264,140 @@ void block_organizer::handle_accept(const code& ec, branch::ptr branch, result_h
     validator_.connect(branch, connect_handler);
 }
 
+// Proposal sub-sequence.
+//-----------------------------------------------------------------------------
+
+// The state of one proposal validation, shared by its handlers. Each proposal
+// has its own validator, as the block populator is not thread safe. A proposal
+// is a simulation by construction, it never reaches the pool, store or
+// subscribers, so the block's own simulate flag is left as the caller set it.
+struct block_organizer::proposal {
+    block_const_ptr block;
+    std::shared_ptr<validate_block> validator;
+    branch::ptr path;
+    size_t top_height;
+    hash_digest top_hash;
+    std::chrono::steady_clock::time_point started;
+    proposal_validation result;
+    proposal_validation_handler handler;
+};
+
+static std::chrono::microseconds elapsed(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - since);
+}
+
+// This is called from block_chain::validate_proposal.
+// The chain top read here is the snapshot the block is validated against,
+// chain state is promoted from the pool state of that top. Store writes are
+// not excluded, so the top is read again on completion to flag a result that
+// may be stale.
+void block_organizer::validate_proposal(block_const_ptr block, proposal_validation_handler handler) const {
+    auto const state = std::make_shared<proposal>();
+    state->block = block;
+    state->handler = handler;
+    state->result = proposal_validation{proposal_validation::stages::check, 0, false, {}, {}, {}};
+
+    if (stopped()) {
+        handler(error::service_stopped, state->result);
+        return;
+    }
+
+    if ( ! fast_chain_.get_last_height(state->top_height) ||
+         ! fast_chain_.get_block_hash(state->top_hash, state->top_height)) {
+        handler(error::operation_failed, state->result);
+        return;
+    }
+
+#if defined(BITPRIM_WITH_MEMPOOL)
+    state->validator = std::make_shared<validate_block>(dispatch_, fast_chain_, settings_, script_cache_, relay_transactions_, mempool_);
+#else
+    state->validator = std::make_shared<validate_block>(dispatch_, fast_chain_, settings_, script_cache_, relay_transactions_);
+#endif
+    state->validator->start();
+
+    state->started = std::chrono::steady_clock::now();
+
+    // Checks that are independent of chain state.
+    state->validator->check(block, std::bind(&block_organizer::proposal_handle_check, this, _1, state));
+}
+
+// private
+void block_organizer::proposal_handle_check(const code& ec, proposal_ptr proposal) const {
+    proposal->result.check = elapsed(proposal->started);
+
+    if (stopped()) {
+        proposal_complete(error::service_stopped, proposal);
+        return;
+    }
+
+    if (ec) {
+        proposal_complete(ec, proposal);
+        return;
+    }
+
+    proposal->result.stage = proposal_validation::stages::accept;
+    proposal->started = std::chrono::steady_clock::now();
+
+    auto const& parent = proposal->block->header().previous_block_hash();
+
+    // Only a block on the snapshot top could be organized as is.
+    if (parent != proposal->top_hash) {
+        size_t height;
+        auto const known = fast_chain_.get_height(height, parent);
+        proposal_complete(known ? error::insufficient_work : error::orphan_block, proposal);
+        return;
+    }
+
+    proposal->path = std::make_shared<branch>(proposal->top_height);
+    proposal->path->push_front(proposal->block);
+    proposal->result.height = proposal->path->top_height();
+
+    // Checks that are dependent on chain state and prevouts.
+    proposal->validator->accept(proposal->path, std::bind(&block_organizer::proposal_handle_accept, this, _1, proposal));
+}
+
+// private
+void block_organizer::proposal_handle_accept(const code& ec, proposal_ptr proposal) const {
+    proposal->result.accept = elapsed(proposal->started);
+
+    if (stopped()) {
+        proposal_complete(error::service_stopped, proposal);
+        return;
+    }
+
+    if (ec) {
+        proposal_complete(ec, proposal);
+        return;
+    }
+
+    proposal->result.stage = proposal_validation::stages::connect;
+    proposal->started = std::chrono::steady_clock::now();
+
+    // Checks that include script validation.
+    proposal->validator->connect(proposal->path, std::bind(&block_organizer::proposal_handle_connect, this, _1, proposal));
+}
+
+// private
+void block_organizer::proposal_handle_connect(const code& ec, proposal_ptr proposal) const {
+    proposal->result.connect = elapsed(proposal->started);
+    proposal_complete(stopped() ? error::service_stopped : ec, proposal);
+}
+
+// private
+void block_organizer::proposal_complete(const code& ec, proposal_ptr proposal) const {
+    size_t top_height;
+    hash_digest top_hash;
+
+    proposal->result.chain_changed =
+        ! fast_chain_.get_last_height(top_height) ||
+        top_height != proposal->top_height ||
+        ! fast_chain_.get_block_hash(top_hash, top_height) ||
+        top_hash != proposal->top_hash;
+
+    proposal->block->validation.error = ec;
+    proposal->handler(ec, proposal->result);
+}
+
 #ifdef BITPRIM_DB_NEW
 bool block_organizer::is_branch_double_spend(branch::ptr const& branch) const {
     // precondition: branch->blocks() != nullptr
@@ -327,7 +529,7 @@ local_utxo_set_t create_outgoing_utxo_set(block_const_ptr_list_ptr const& outgoi
 
     for (auto const& block : *outgoing_blocks) {
         // std::cout << "create_branch_utxo_set - block: {" << encode_hash(block->hash()) << "}" << std::endl;
-        res.push_back(create_local_utxo_set(*block));
+        res.push_back(std::make_shared<local_utxo_t const>(create_local_utxo_set(*block)));
     }
 
     return res;
@@ -431,7 +633,7 @@ void block_organizer::handle_connect(const code& ec, branch::ptr branch, result_
     // TODO: consider relay of pooled blocks by modifying subscriber semantics.
     if (work <= threshold) {
         if ( ! top_block.simulate) {
-            block_pool_.add(branch->top());
+            block_pool_.add(branch->top(), branch->top_outpoints());
         }
 
         handler(error::insufficient_work);
@@ -448,7 +650,7 @@ void block_organizer::handle_connect(const code& ec, branch::ptr branch, result_
     }
 #endif
 
-    // TODO: create a simulated validation path that does not block others.
+    // Proposals should use validate_proposal, which does not block others.
     if (top_block.simulate) {
         handler(error::success);
         return;
@@ -498,16 +700,16 @@ void block_organizer::handle_reorganized(const code& ec, branch::const_ptr branc
 
 // private
 void block_organizer::notify(size_t branch_height, block_const_ptr_list_const_ptr branch, block_const_ptr_list_const_ptr original) {
-    // This invokes handlers within the criticial section (deadlock risk).
-    subscriber_->invoke(error::success, branch_height, branch, original);
+    // This queues the notification, handlers are invoked by the notifier.
+    notifier_.notify(branch_height, branch, original);
 }
 
 void block_organizer::subscribe(reorganize_handler&& handler) {
-    subscriber_->subscribe(std::move(handler), error::service_stopped, 0, {}, {});
+    notifier_.subscribe_blockchain(std::move(handler));
 }
 
 void block_organizer::unsubscribe() {
-    subscriber_->relay(error::success, 0, {}, {});
+    notifier_.unsubscribe_blockchain();
 }
 
 // Queries.
@@ -515,6 +717,7 @@ void block_organizer::unsubscribe() {
 
 void block_organizer::filter(get_data_ptr message) const {
     block_pool_.filter(message);
+    orphan_pool_.filter(message);
 }
 
 // Utility.
@@ -0,0 +1,77 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/pools/block_outpoints.hpp>
+
+#include <memory>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/blockchain/pools/branch.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+using namespace bc::chain;
+
+namespace {
+
+local_spent_t create_local_spent_set(chain::block const& block) {
+    local_spent_t res;
+    auto const& txs = block.transactions();
+
+    if (txs.empty()) {
+        return res;
+    }
+
+    res.reserve(block.total_inputs(false));
+
+    // The coinbase input does not spend a previous output.
+    for (auto tx = txs.begin() + 1; tx != txs.end(); ++tx) {
+        for (auto const& input : tx->inputs()) {
+            res.insert(input.previous_output());
+        }
+    }
+
+    return res;
+}
+
+} // namespace
+
+block_outpoints::block_outpoints(block_const_ptr block)
+    : block_(block)
+    , created_(create_local_utxo_set(*block))
+    , spent_(create_local_spent_set(*block))
+{}
+
+block_const_ptr block_outpoints::block() const {
+    return block_;
+}
+
+local_utxo_t const& block_outpoints::created() const {
+    return created_;
+}
+
+local_spent_t const& block_outpoints::spent() const {
+    return spent_;
+}
+
+bool block_outpoints::spends(output_point const& outpoint) const {
+    return spent_.find(outpoint) != spent_.end();
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
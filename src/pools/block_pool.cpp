@@ -20,6 +20,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <memory>
 #include <utility>
 #include <bitcoin/blockchain/define.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
@@ -43,10 +44,18 @@ size_t block_pool::size() const
 }
 
 void block_pool::add(block_const_ptr valid_block)
+{
+    add(valid_block, std::make_shared<const block_outpoints>(valid_block));
+}
+
+// The outpoints are indexed once here and shared with every branch path.
+void block_pool::add(block_const_ptr valid_block,
+    block_outpoints::const_ptr outpoints)
 {
     // The block must be successfully validated.
     ////BITCOIN_ASSERT(!block->validation.error);
-    block_entry entry{ valid_block };
+    BITCOIN_ASSERT(outpoints && outpoints->block() == valid_block);
+    block_entry entry{ valid_block, outpoints };
 
     // Not all blocks will have validation state.
     ////BITCOIN_ASSERT(block->validation.state);
@@ -89,6 +98,11 @@ void block_pool::remove(block_const_ptr_list_const_ptr accepted_blocks)
     auto saver = [&](const hash_digest& hash){ child_hashes.push_back(hash); };
     auto& left = blocks_.left;
 
+    // All erasures are made under one lock, filtering waits once.
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
     for (auto block: *accepted_blocks)
     {
         auto it = left.find(block_entry{ block->hash() });
@@ -99,12 +113,7 @@ void block_pool::remove(block_const_ptr_list_const_ptr accepted_blocks)
         // Copy hashes of all children of nodes we delete.
         const auto& children = it->first.children();
         std::for_each(children.begin(), children.end(), saver);
-
-        ///////////////////////////////////////////////////////////////////////
-        // Critical Section
-        unique_lock lock(mutex_);
         left.erase(it);
-        ///////////////////////////////////////////////////////////////////////
     }
 
     // Move all children that we have orphaned to the root (give them height).
@@ -116,76 +125,58 @@ void block_pool::remove(block_const_ptr_list_const_ptr accepted_blocks)
         if (it == left.end())
             continue;
 
-        // Copy the entry so that it can be deleted and replanted with height.
-        const auto copy = it->first;
-        const auto height = copy.block()->header().validation.height;
+        // The height is replaced in place (no copy, erase and insert).
         BITCOIN_ASSERT(it->second == 0);
-
-        // Critical Section
-        ///////////////////////////////////////////////////////////////////////
-        unique_lock lock(mutex_);
-        left.erase(it);
-        blocks_.insert({ copy, height });
-        ///////////////////////////////////////////////////////////////////////
+        left.replace_data(it, it->first.block()->header().validation.height);
     }
+    ///////////////////////////////////////////////////////////////////////////
 }
 
 // protected
+// Walks the trees of the expired roots breadth first (no recursion).
 void block_pool::prune(const hash_list& hashes, size_t minimum_height)
 {
-    hash_list child_hashes;
-    auto saver = [&](const hash_digest& hash){ child_hashes.push_back(hash); };
     auto& left = blocks_.left;
+    hash_list pending(hashes);
 
-    for (auto& hash: hashes)
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    for (size_t index = 0; index < pending.size(); ++index)
     {
-        const auto it = left.find(block_entry{ hash });
+        const auto it = left.find(block_entry{ pending[index] });
         BITCOIN_ASSERT(it != left.end());
 
         const auto height = it->first.block()->header().validation.height;
 
-        // Delete all roots and expired non-roots and recurse their children.
+        // Delete all roots and expired non-roots and continue to children.
         if (it->second != 0 || height < minimum_height)
         {
-            // delete
             const auto& children = it->first.children();
-            std::for_each(children.begin(), children.end(), saver);
-
-            ///////////////////////////////////////////////////////////////////
-            // Critical Section
-            unique_lock lock(mutex_);
+            pending.insert(pending.end(), children.begin(), children.end());
             left.erase(it);
-            ///////////////////////////////////////////////////////////////////
-
             continue;
         }
 
-        // Copy the entry so that it can be deleted and replanted with height.
-        const auto copy = it->first;
-
-        // Critical Section
-        ///////////////////////////////////////////////////////////////////////
-        unique_lock lock(mutex_);
-        left.erase(it);
-        blocks_.insert({ copy, height });
-        ///////////////////////////////////////////////////////////////////////
+        // An unexpired child of an expired node becomes a root.
+        left.replace_data(it, height);
     }
-
-    // Recurse the children to span the tree.
-    if (!child_hashes.empty())
-        prune(child_hashes, minimum_height);
+    ///////////////////////////////////////////////////////////////////////////
 }
 
 void block_pool::prune(size_t top_height)
 {
     hash_list hashes;
     const auto minimum_height = floor_subtract(top_height, maximum_depth_);
+    const auto& right = blocks_.right;
+
+    // Roots are ordered by height and non-roots have zero height, so only
+    // the expired roots are visited.
+    const auto end = right.lower_bound(minimum_height);
 
-    // TODO: not using table sort here, should stop iterating once above min.
-    // Iterate over all root nodes with insufficient height.
-    for (auto it: blocks_.right)
-        if (it.first != 0 && it.first < minimum_height)
-            hashes.push_back(it.second.hash());
+    for (auto it = right.upper_bound(0); it != end; ++it)
+        hashes.push_back(it->second.hash());
 
     // Get outside of the hash table iterator before deleting.
     if (!hashes.empty())
@@ -197,26 +188,19 @@ void block_pool::filter(get_data_ptr message) const
     auto& inventories = message->inventories();
     const auto& left = blocks_.left;
 
-    for (auto it = inventories.begin(); it != inventories.end();)
+    const auto pooled = [&left](const libbitcoin::message::inventory_vector& inventory)
     {
-        if (!it->is_block_type())
-        {
-            ++it;
-            continue;
-        }
-
-        const block_entry entry{ it->hash() };
+        return inventory.is_block_type() &&
+            left.find(block_entry{ inventory.hash() }) != left.end();
+    };
 
-        ///////////////////////////////////////////////////////////////////////
-        // Critical Section
-        mutex_.lock_shared();
-        const auto found = (left.find(entry) != left.end());
-        mutex_.unlock_shared();
-        ///////////////////////////////////////////////////////////////////////
-
-        // TODO: optimize (prevent repeating vector moves).
-        it = found ? inventories.erase(it) : it + 1;
-    }
+    // One lock for the message, matches are erased in one pass.
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+    inventories.erase(std::remove_if(inventories.begin(), inventories.end(),
+        pooled), inventories.end());
+    ///////////////////////////////////////////////////////////////////////////
 }
 
 // protected
@@ -229,12 +213,13 @@ bool block_pool::exists(block_const_ptr candidate_block) const
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
     shared_lock lock(mutex_);
-    return left.find(block_entry{ candidate_block }) != left.end();
+    return left.find(block_entry{ candidate_block->hash() }) != left.end();
     ///////////////////////////////////////////////////////////////////////////
 }
 
 // protected
-block_const_ptr block_pool::parent(block_const_ptr block) const
+block_const_ptr block_pool::parent(block_const_ptr block,
+    block_outpoints::const_ptr& out_outpoints, uint256_t& out_proof) const
 {
     // The block may be validated (pool) or not (new).
     const block_entry parent_entry{ block->header().previous_block_hash() };
@@ -244,7 +229,13 @@ block_const_ptr block_pool::parent(block_const_ptr block) const
     ///////////////////////////////////////////////////////////////////////////
     shared_lock lock(mutex_);
     const auto parent = left.find(parent_entry);
-    return parent == left.end() ? nullptr : parent->first.block();
+
+    if (parent == left.end())
+        return nullptr;
+
+    out_outpoints = parent->first.outpoints();
+    out_proof = parent->first.proof();
+    return parent->first.block();
     ///////////////////////////////////////////////////////////////////////////
 }
 
@@ -256,10 +247,15 @@ branch::ptr block_pool::get_path(block_const_ptr block) const
     if (exists(block))
         return trace;
 
+    // Only the candidate is indexed here, pooled blocks reuse their index
+    // and proof, so the branch work is a sum of cached values.
+    auto outpoints = std::make_shared<const block_outpoints>(block);
+    auto proof = block->proof();
+
     while (block)
     {
-        trace->push_front(block);
-        block = parent(block);
+        trace->push_front(block, outpoints, proof);
+        block = parent(block, outpoints, proof);
     }
 
     return trace;
@@ -49,15 +49,16 @@ local_utxo_t create_local_utxo_set(chain::block const& block) {
     return res;
 }
 
+// The blocks were indexed when pooled, this just references their maps.
 local_utxo_set_t create_branch_utxo_set(branch::const_ptr const& branch) {
-    auto blocks = *branch->blocks();
+    auto const& outpoints = branch->outpoints();
 
     local_utxo_set_t res;
-    res.reserve(branch->size());
+    res.reserve(outpoints.size());
 
-    for (auto const& block : blocks) {
-        // std::cout << "create_branch_utxo_set - block: {" << encode_hash(block->hash()) << "}" << std::endl;
-        res.push_back(create_local_utxo_set(*block));
+    for (auto const& index : outpoints) {
+        // Aliasing, the map lives as long as the index (and its block).
+        res.emplace_back(index, std::addressof(index->created()));
     }
 
     return res;
@@ -69,6 +70,7 @@ local_utxo_set_t create_branch_utxo_set(branch::const_ptr const& branch) {
 branch::branch(size_t height)
     : height_(height)
     , blocks_(std::make_shared<block_const_ptr_list>())
+    , work_(0)
 {}
 
 void branch::set_height(size_t height) {
@@ -77,6 +79,16 @@ void branch::set_height(size_t height) {
 
 // Front is the top of the chain plus one, back is the top of the branch.
 bool branch::push_front(block_const_ptr block) {
+    return push_front(block, std::make_shared<const block_outpoints>(block));
+}
+
+bool branch::push_front(block_const_ptr block, block_outpoints::const_ptr outpoints) {
+    return push_front(block, std::move(outpoints), block->proof());
+}
+
+bool branch::push_front(block_const_ptr block, block_outpoints::const_ptr outpoints, uint256_t const& proof) {
+    BITCOIN_ASSERT(outpoints && outpoints->block() == block);
+
     auto const linked = [this](block_const_ptr block) {
         auto const& front = blocks_->front()->header();
         return front.previous_block_hash() == block->hash();
@@ -84,6 +96,8 @@ bool branch::push_front(block_const_ptr block) {
 
     if (empty() || linked(block)) {
         blocks_->insert(blocks_->begin(), block);
+        outpoints_.insert(outpoints_.begin(), std::move(outpoints));
+        work_ += proof;
         return true;
     }
 
@@ -98,6 +112,14 @@ size_t branch::top_height() const {
     return height() + size();
 }
 
+block_outpoints::const_ptr branch::top_outpoints() const {
+    return outpoints_.empty() ? nullptr : outpoints_.back();
+}
+
+std::vector<block_outpoints::const_ptr> const& branch::outpoints() const {
+    return outpoints_;
+}
+
 block_const_ptr_list_const_ptr branch::blocks() const {
     return blocks_;
 }
@@ -152,12 +174,7 @@ uint32_t branch::median_time_past_at(size_t index) const {
 // the same amount of work as a shorter segment, so an attacker gains no
 // advantage from that option, and it will be caught in validation.
 uint256_t branch::work() const {
-    uint256_t total;
-    // Not using accumulator here avoids repeated copying of uint256 object.
-    for (auto block : *blocks_) {
-        total += block->proof();
-    }
-    return total;
+    return work_;
 }
 
 // TODO: convert to a direct block pool query when the branch goes away.
@@ -203,23 +220,12 @@ void branch::populate_spent(output_point const& outpoint) const {
         return;
     }
 
-    // TODO: use hash table storage of block's inputs for block pool entries.
-    auto const blocks = [&outpoint](block_const_ptr block) {
-        auto const transactions = [&outpoint](const transaction& tx) {
-            auto const prevout_match = [&outpoint](const input& input) {
-                return input.previous_output() == outpoint;
-            };
-
-            auto const& ins = tx.inputs();
-            return std::any_of(ins.begin(), ins.end(), prevout_match);
-        };
-
-        auto const& txs = block->transactions();
-        BITCOIN_ASSERT_MSG(!txs.empty(), "empty block in branch");
-        return std::any_of(txs.begin() + 1, txs.end(), transactions);
+    // One hash table lookup per block, the spends were indexed when pooled.
+    auto const spends = [&outpoint](block_outpoints::const_ptr const& index) {
+        return index->spends(outpoint);
     };
 
-    auto spent = std::any_of(blocks_->begin(), blocks_->end() - 1, blocks);
+    auto spent = std::any_of(outpoints_.begin(), outpoints_.end() - 1, spends);
     prevout.spent = spent;
     prevout.confirmed = prevout.spent;
 }
@@ -265,7 +271,7 @@ void branch::populate_prevout(output_point const& outpoint) const {
 //TODO(fernando): use the type alias instead of the std::unord...
 
 // TODO: absorb into the main chain for speed and code consolidation.
-void branch::populate_prevout(output_point const& outpoint, std::vector<std::unordered_map<point, output const*>> const& branch_utxo) const {
+void branch::populate_prevout(output_point const& outpoint, local_utxo_set_t const& branch_utxo) const {
     auto& prevout = outpoint.validation;
 
     // In case this input is a coinbase or the prevout is spent.
@@ -310,7 +316,7 @@ void branch::populate_prevout(output_point const& outpoint, std::vector<std::uno
     for (size_t forward = 0; forward < count; ++forward) {
         size_t const index = count - forward - 1u;
         auto const& txs = blocks[index]->transactions();
-        auto const& local_utxo = branch_utxo[index];
+        auto const& local_utxo = *branch_utxo[index];
 
         prevout.coinbase = false;
         auto it = local_utxo.find(outpoint);
@@ -0,0 +1,488 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/pools/chain_notifier.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+#define NAME "chain_notifier"
+
+// A subscriber with its queue. At most one pool task drains the queue, so
+// the handler is invoked in order and never concurrently. The task holds the
+// subscription, which may outlive the notifier.
+template <typename Event>
+class chain_notifier::subscription
+  : public std::enable_shared_from_this<subscription<Event>>
+{
+public:
+    typedef std::function<bool(const Event&)> deliver_function;
+
+    subscription(dispatcher& dispatch, deliver_function deliver, size_t limit)
+      : dispatch_(dispatch)
+      , deliver_(std::move(deliver))
+      , limit_(limit)
+      , scheduled_(false)
+      , closed_(false)
+      , final_pending_(false)
+    {}
+
+    // Queue the events, coalescing where possible, returns the number of
+    // events dropped to keep the queue within the limit.
+    size_t push(const std::vector<Event>& events, bool bounded) {
+        size_t dropped = 0;
+        auto schedule = false;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            if (closed_) {
+                return 0;
+            }
+
+            for (auto const& event : events) {
+                if ( ! queue_.empty() && merge(queue_.back(), event)) {
+                    // A subscriber this far behind is closed, it resyncs.
+                    if (bounded && limit_ != 0 && weight(queue_.back()) > limit_) {
+                        dropped += queue_.size();
+                        overflow();
+                        break;
+                    }
+
+                    continue;
+                }
+
+                queue_.push_back(event);
+
+                if (bounded && limit_ != 0 && queue_.size() > limit_) {
+                    queue_.pop_front();
+                    ++dropped;
+                }
+            }
+
+            if ( ! scheduled_ && ( ! queue_.empty() || final_pending_)) {
+                scheduled_ = true;
+                schedule = true;
+            }
+        }
+
+        if (schedule) {
+            auto const self = this->shared_from_this();
+            dispatch_.concurrent([self]() {
+                self->drain();
+            });
+        }
+
+        return dropped;
+    }
+
+    // Discard queued events and send the final one, after the event being
+    // delivered (if any).
+    void close(const Event& last) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            if (closed_) {
+                return;
+            }
+
+            closed_ = true;
+            queue_.clear();
+
+            if (scheduled_) {
+                final_ = last;
+                final_pending_ = true;
+                return;
+            }
+        }
+
+        deliver_(last);
+    }
+
+    bool closed() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return closed_;
+    }
+
+private:
+    static bool merge(reorganization& pending, const reorganization& next) {
+        return chain_notifier::coalesce(pending, next);
+    }
+
+    static bool merge(transaction&, const transaction&) {
+        return false;
+    }
+
+    // The blocks a coalesced reorganization holds, bounded by the limit.
+    static size_t weight(const reorganization& event) {
+        return event.incoming ? event.incoming->size() : 0;
+    }
+
+    static size_t weight(const transaction&) {
+        return 0;
+    }
+
+    // private, call under lock.
+    // Discard the queue, the subscriber is sent operation_failed next.
+    void overflow() {
+        closed_ = true;
+        queue_.clear();
+        final_ = Event{};
+        final_.ec = error::operation_failed;
+        final_pending_ = true;
+    }
+
+    void drain() {
+        while (true) {
+            Event next;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+
+                if (queue_.empty()) {
+                    if ( ! final_pending_) {
+                        scheduled_ = false;
+                        return;
+                    }
+
+                    final_pending_ = false;
+                    next = final_;
+                } else {
+                    next = queue_.front();
+                    queue_.pop_front();
+                }
+            }
+
+            // A false return ends the subscription.
+            if ( ! deliver_(next) || next.ec) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                closed_ = true;
+                final_pending_ = false;
+                queue_.clear();
+                return;
+            }
+        }
+    }
+
+    dispatcher& dispatch_;
+    const deliver_function deliver_;
+    const size_t limit_;
+
+    // These are protected by mutex.
+    std::deque<Event> queue_;
+    bool scheduled_;
+    bool closed_;
+    bool final_pending_;
+    Event final_;
+    mutable std::mutex mutex_;
+};
+
+template <typename Subscriptions>
+static void prune(Subscriptions& subscriptions) {
+    subscriptions.erase(std::remove_if(subscriptions.begin(), subscriptions.end(),
+        [](typename Subscriptions::const_reference subscriber) {
+            return subscriber->closed();
+        }), subscriptions.end());
+}
+
+static bool same_blocks(block_const_ptr_list::const_iterator first,
+    block_const_ptr_list::const_iterator last,
+    block_const_ptr_list::const_iterator other) {
+    return std::equal(first, last, other, [](const block_const_ptr& left, const block_const_ptr& right) {
+        return left->hash() == right->hash();
+    });
+}
+
+chain_notifier::chain_notifier(threadpool& pool, size_t queue_limit,
+    std::chrono::milliseconds transaction_window)
+    : dispatch_(pool, NAME)
+    , queue_limit_(queue_limit)
+    , window_(transaction_window)
+    , dropped_reorganizations_(0)
+    , dropped_transactions_(0)
+    , stopped_(true)
+    , window_scheduled_(false)
+    , owner_(std::make_shared<owner>())
+{
+    owner_->notifier = this;
+}
+
+chain_notifier::~chain_notifier() {
+    stop();
+
+    std::lock_guard<std::mutex> lock(owner_->mutex);
+    owner_->notifier = nullptr;
+}
+
+// Start/stop sequences.
+//-----------------------------------------------------------------------------
+
+bool chain_notifier::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if ( ! stopped_) {
+        return true;
+    }
+
+    stopped_ = false;
+    return true;
+}
+
+bool chain_notifier::stop() {
+    std::vector<block_subscription_ptr> blocks;
+    std::vector<transaction_subscription_ptr> transactions;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (stopped_) {
+            return true;
+        }
+
+        stopped_ = true;
+        blocks.swap(block_subscriptions_);
+        transactions.swap(transaction_subscriptions_);
+        pending_.clear();
+        window_scheduled_ = false;
+    }
+
+    for (auto const& subscriber : blocks) {
+        subscriber->close({error::service_stopped, 0, {}, {}});
+    }
+
+    for (auto const& subscriber : transactions) {
+        subscriber->close({error::service_stopped, {}});
+    }
+
+    return true;
+}
+
+// Subscription.
+//-----------------------------------------------------------------------------
+
+void chain_notifier::subscribe_blockchain(reorganize_handler&& handler) {
+    auto deliver = [handler](const reorganization& event) {
+        return handler(event.ec, event.fork_height, event.incoming, event.outgoing);
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if ( ! stopped_) {
+            block_subscriptions_.push_back(std::make_shared<subscription<reorganization>>(dispatch_, deliver, queue_limit_));
+            return;
+        }
+    }
+
+    handler(error::service_stopped, 0, {}, {});
+}
+
+void chain_notifier::subscribe_transaction(transaction_handler&& handler) {
+    auto deliver = [handler](const transaction& event) {
+        return handler(event.ec, event.tx);
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if ( ! stopped_) {
+            transaction_subscriptions_.push_back(std::make_shared<subscription<transaction>>(dispatch_, deliver, queue_limit_));
+            return;
+        }
+    }
+
+    handler(error::service_stopped, {});
+}
+
+void chain_notifier::unsubscribe_blockchain() {
+    std::vector<reorganization> const events{ {error::success, 0, {}, {}} };
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (auto const& subscriber : block_subscriptions_) {
+        subscriber->push(events, false);
+    }
+}
+
+void chain_notifier::unsubscribe_transaction() {
+    std::vector<transaction> const events{ {error::success, {}} };
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Pending transactions precede the notification.
+    queue(pending_);
+    pending_.clear();
+
+    for (auto const& subscriber : transaction_subscriptions_) {
+        subscriber->push(events, false);
+    }
+}
+
+// Notification.
+//-----------------------------------------------------------------------------
+
+void chain_notifier::notify(size_t fork_height,
+    block_const_ptr_list_const_ptr incoming,
+    block_const_ptr_list_const_ptr outgoing) {
+    std::vector<reorganization> const events{ {error::success, fork_height, incoming, outgoing} };
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (stopped_) {
+        return;
+    }
+
+    prune(block_subscriptions_);
+
+    for (auto const& subscriber : block_subscriptions_) {
+        dropped_reorganizations_ += subscriber->push(events, true);
+    }
+}
+
+void chain_notifier::notify(transaction_const_ptr tx) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (stopped_) {
+        return;
+    }
+
+    if (window_ == std::chrono::milliseconds::zero()) {
+        queue({ {error::success, tx} });
+        return;
+    }
+
+    pending_.push_back({error::success, tx});
+
+    if (window_scheduled_) {
+        return;
+    }
+
+    window_scheduled_ = true;
+    auto const self = owner_;
+
+    // The timer is not canceled on stop, it then finds nothing to flush.
+    dispatch_.delayed(window_, [self](const code&) {
+        std::lock_guard<std::mutex> guard(self->mutex);
+
+        if (self->notifier != nullptr) {
+            self->notifier->flush();
+        }
+    });
+}
+
+// private, call under lock.
+void chain_notifier::queue(const std::vector<transaction>& batch) {
+    if (batch.empty()) {
+        return;
+    }
+
+    prune(transaction_subscriptions_);
+
+    for (auto const& subscriber : transaction_subscriptions_) {
+        dropped_transactions_ += subscriber->push(batch, true);
+    }
+}
+
+// private
+// Transactions notified within a window are queued together, so a high
+// transaction rate costs one task per subscriber per window.
+void chain_notifier::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    window_scheduled_ = false;
+
+    std::vector<transaction> batch;
+    batch.swap(pending_);
+    queue(batch);
+}
+
+// Coalescing.
+//-----------------------------------------------------------------------------
+
+// Both are in the order of the chain (the last incoming block is the top).
+bool chain_notifier::coalesce(reorganization& pending, const reorganization& next) {
+    if (pending.ec || next.ec || ! pending.incoming || ! pending.outgoing ||
+        ! next.incoming || ! next.outgoing) {
+        return false;
+    }
+
+    auto const& pending_in = *pending.incoming;
+    auto const& next_out = *next.outgoing;
+    auto const pending_top = pending.fork_height + pending_in.size();
+
+    // The next fork is within the pending incoming blocks, which it pops
+    // above its fork and extends.
+    if (next.fork_height >= pending.fork_height) {
+        if (next.fork_height > pending_top ||
+            next_out.size() != pending_top - next.fork_height) {
+            return false;
+        }
+
+        auto const kept = pending_in.begin() + (next.fork_height - pending.fork_height);
+
+        if ( ! same_blocks(kept, pending_in.end(), next_out.begin())) {
+            return false;
+        }
+
+        auto const incoming = std::make_shared<block_const_ptr_list>(pending_in.begin(), kept);
+        incoming->insert(incoming->end(), next.incoming->begin(), next.incoming->end());
+        pending.incoming = incoming;
+        return true;
+    }
+
+    // The next fork is below the pending fork, it pops the chain blocks
+    // between the forks and all of the pending incoming blocks.
+    auto const between = pending.fork_height - next.fork_height;
+
+    if (next_out.size() != between + pending_in.size() ||
+        ! same_blocks(pending_in.begin(), pending_in.end(), next_out.begin() + between)) {
+        return false;
+    }
+
+    auto const outgoing = std::make_shared<block_const_ptr_list>(next_out.begin(), next_out.begin() + between);
+    outgoing->insert(outgoing->end(), pending.outgoing->begin(), pending.outgoing->end());
+    pending.fork_height = next.fork_height;
+    pending.incoming = next.incoming;
+    pending.outgoing = outgoing;
+    return true;
+}
+
+// Properties.
+//-----------------------------------------------------------------------------
+
+size_t chain_notifier::queue_limit() const {
+    return queue_limit_;
+}
+
+size_t chain_notifier::dropped_reorganizations() const {
+    return dropped_reorganizations_;
+}
+
+size_t chain_notifier::dropped_transactions() const {
+    return dropped_transactions_;
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
@@ -0,0 +1,375 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/pools/organize_queue.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+#define NAME "organize_queue"
+
+typedef std::chrono::steady_clock clock_type;
+
+static organize_queue::duration elapsed(clock_type::time_point since) {
+    return std::chrono::duration_cast<organize_queue::duration>(clock_type::now() - since);
+}
+
+// One thread, items are organized in order and the organizers are not
+// reentered. Producers never run on it, so a full queue cannot starve it.
+organize_queue::organize_queue(size_t block_capacity,
+    size_t transaction_capacity, block_function check_block,
+    block_function organize_block, transaction_function organize_transaction)
+    : block_capacity_(block_capacity)
+    , transaction_capacity_(transaction_capacity)
+    , check_block_(std::move(check_block))
+    , organize_block_(std::move(organize_block))
+    , organize_transaction_(std::move(organize_transaction))
+    , pool_(1)
+    , dispatch_(pool_, NAME)
+    , stopped_(true)
+    , draining_(false)
+    , saturated_(false)
+    , metrics_()
+    , signaled_(false)
+{}
+
+organize_queue::~organize_queue() {
+    stop();
+    pool_.shutdown();
+    pool_.join();
+}
+
+// Start/stop sequences.
+//-----------------------------------------------------------------------------
+
+bool organize_queue::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = false;
+    return true;
+}
+
+bool organize_queue::stop() {
+    std::deque<block_item> blocks;
+    std::deque<transaction_item> transactions;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (stopped_) {
+            return true;
+        }
+
+        stopped_ = true;
+        blocks.swap(blocks_);
+        transactions.swap(transactions_);
+        update_saturation();
+    }
+
+    // Waiting producers complete as stopped.
+    room_.notify_all();
+    signal_backpressure();
+
+    // The drain task completes the item in progress, if any.
+    pool_.shutdown();
+    pool_.join();
+
+    for (auto const& queued : blocks) {
+        queued.handler(error::service_stopped);
+    }
+
+    for (auto const& queued : transactions) {
+        queued.handler(error::service_stopped);
+    }
+
+    return true;
+}
+
+// Organize sequence.
+//-----------------------------------------------------------------------------
+
+void organize_queue::organize(block_const_ptr block, result_handler handler) {
+    if (block_capacity_ == 0) {
+        auto const checked = check(block);
+        auto const ec = checked.valid() ? checked.get() : code(error::success);
+
+        if (ec) {
+            handler(ec);
+            return;
+        }
+
+        organize_block_(block, handler);
+        return;
+    }
+
+    // The check starts before waiting for room, so it is bounded by the
+    // number of producers and not only by the capacity.
+    enqueue(blocks_, block_capacity_, metrics_.peak_blocks,
+        metrics_.throttled_blocks,
+        {block, handler, clock_type::now(), check(block)});
+}
+
+void organize_queue::organize(transaction_const_ptr tx, result_handler handler) {
+    if (transaction_capacity_ == 0) {
+        organize_transaction_(tx, handler);
+        return;
+    }
+
+    enqueue(transactions_, transaction_capacity_,
+        metrics_.peak_transactions, metrics_.throttled_transactions,
+        {tx, handler, clock_type::now(), {}});
+}
+
+// private
+std::shared_future<code> organize_queue::check(block_const_ptr block) const {
+    if ( ! check_block_) {
+        return {};
+    }
+
+    auto const checked = std::make_shared<std::promise<code>>();
+    auto result = checked->get_future().share();
+
+    check_block_(block, [checked](const code& ec) {
+        checked->set_value(ec);
+    });
+
+    return result;
+}
+
+// private
+// A full queue parks the producer until the drain task makes room, which
+// throttles the peer instead of failing (and dropping) it.
+template <typename Message>
+void organize_queue::enqueue(std::deque<item<Message>>& queue,
+    size_t capacity, size_t& peak, size_t& throttled,
+    item<Message>&& queued) {
+    auto stopped = false;
+    auto schedule = false;
+    auto changed = false;
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        if ( ! stopped_ && queue.size() >= capacity) {
+            ++throttled;
+            room_.wait(lock, [this, &queue, capacity]() {
+                return stopped_ || queue.size() < capacity;
+            });
+        }
+
+        stopped = stopped_;
+
+        if ( ! stopped) {
+            queue.push_back(std::move(queued));
+            peak = std::max(peak, queue.size());
+            changed = update_saturation();
+            schedule = ! draining_;
+            draining_ = true;
+        }
+    }
+
+    if (changed) {
+        signal_backpressure();
+    }
+
+    if (stopped) {
+        queued.handler(error::service_stopped);
+        return;
+    }
+
+    if (schedule) {
+        dispatch_.concurrent([this]() {
+            drain();
+        });
+    }
+}
+
+// private
+// At most one drain task is scheduled, it ends once both queues are empty.
+void organize_queue::drain() {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while ( ! stopped_ && ( ! blocks_.empty() || ! transactions_.empty())) {
+        organize_next(lock);
+    }
+
+    draining_ = false;
+}
+
+// private
+// Blocks are organized before transactions, each kind in order of arrival.
+void organize_queue::organize_next(std::unique_lock<std::mutex>& lock) {
+    if ( ! blocks_.empty()) {
+        auto const next = std::move(blocks_.front());
+        blocks_.pop_front();
+
+        auto const wait = elapsed(next.queued);
+        metrics_.block_wait += wait;
+        metrics_.block_wait_maximum = std::max(metrics_.block_wait_maximum, wait);
+        auto const changed = update_saturation();
+        lock.unlock();
+        room_.notify_all();
+
+        if (changed) {
+            signal_backpressure();
+        }
+
+        auto const started = clock_type::now();
+        auto const handler = next.handler;
+
+        auto const complete = [this, started, handler](const code& ec) {
+            {
+                std::lock_guard<std::mutex> guard(mutex_);
+                ++metrics_.organized_blocks;
+                metrics_.block_organize += elapsed(started);
+            }
+
+            handler(ec);
+        };
+
+        // The check of this block ran while the previous ones organized.
+        auto const ec = next.checked.valid() ? next.checked.get() :
+            code(error::success);
+
+        if (ec) {
+            complete(ec);
+        } else {
+            organize_block_(next.message, complete);
+        }
+
+        lock.lock();
+        return;
+    }
+
+    auto const next = std::move(transactions_.front());
+    transactions_.pop_front();
+
+    auto const wait = elapsed(next.queued);
+    metrics_.transaction_wait += wait;
+    metrics_.transaction_wait_maximum = std::max(metrics_.transaction_wait_maximum, wait);
+    auto const changed = update_saturation();
+    lock.unlock();
+    room_.notify_all();
+
+    if (changed) {
+        signal_backpressure();
+    }
+
+    auto const started = clock_type::now();
+    auto const handler = next.handler;
+
+    organize_transaction_(next.message, [this, started, handler](const code& ec) {
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            ++metrics_.organized_transactions;
+            metrics_.transaction_organize += elapsed(started);
+        }
+
+        handler(ec);
+    });
+
+    lock.lock();
+}
+
+// private, call under lock.
+// Saturated once either queue is full, cleared once both are half empty.
+bool organize_queue::update_saturation() {
+    auto const full =
+        (block_capacity_ != 0 && blocks_.size() >= block_capacity_) ||
+        (transaction_capacity_ != 0 && transactions_.size() >= transaction_capacity_);
+
+    auto const drained =
+        blocks_.size() <= block_capacity_ / 2 &&
+        transactions_.size() <= transaction_capacity_ / 2;
+
+    if (saturated_ ? ! drained : ! full) {
+        return false;
+    }
+
+    saturated_ = ! saturated_;
+    return true;
+}
+
+// private
+// Changes are signaled outside of the queue lock. Concurrent changes are
+// serialized here and only the current state is signaled, so the handler
+// sees alternating values ending in the current saturation.
+void organize_queue::signal_backpressure() {
+    std::lock_guard<std::mutex> guard(signal_mutex_);
+    backpressure_handler handler;
+    bool saturated;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        handler = backpressure_;
+        saturated = saturated_;
+    }
+
+    if (saturated == signaled_) {
+        return;
+    }
+
+    signaled_ = saturated;
+
+    if (handler) {
+        handler(saturated);
+    }
+}
+
+void organize_queue::set_backpressure_handler(backpressure_handler handler) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    backpressure_ = std::move(handler);
+}
+
+// Properties.
+//-----------------------------------------------------------------------------
+
+bool organize_queue::saturated() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return saturated_;
+}
+
+size_t organize_queue::block_capacity() const {
+    return block_capacity_;
+}
+
+size_t organize_queue::transaction_capacity() const {
+    return transaction_capacity_;
+}
+
+organize_queue::metrics organize_queue::get_metrics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto result = metrics_;
+    result.queued_blocks = blocks_.size();
+    result.queued_transactions = transactions_.size();
+    result.block_lag = blocks_.empty() ? duration::zero() : elapsed(blocks_.front().queued);
+    result.transaction_lag = transactions_.empty() ? duration::zero() : elapsed(transactions_.front().queued);
+    return result;
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
@@ -0,0 +1,188 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/pools/orphan_pool.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+orphan_pool::orphan_pool(size_t maximum_size, size_t maximum_count)
+    : maximum_size_(maximum_size)
+    , maximum_count_(maximum_count)
+    , size_(0)
+    , sequence_(0)
+{}
+
+bool orphan_pool::enabled() const {
+    return maximum_size_ != 0 && maximum_count_ != 0;
+}
+
+// private, call under lock.
+void orphan_pool::erase(entries::iterator it) {
+    auto const& header = it->block->header();
+    auto const range = by_parent_.equal_range(header.previous_block_hash());
+
+    for (auto child = range.first; child != range.second; ++child) {
+        if (child->second == it) {
+            by_parent_.erase(child);
+            break;
+        }
+    }
+
+    by_hash_.erase(header.hash());
+    size_ -= it->bytes;
+    entries_.erase(it);
+}
+
+bool orphan_pool::add(block_const_ptr block) {
+    if ( ! enabled() || ! block) {
+        return false;
+    }
+
+    auto const bytes = block->serialized_size(message::version::level::canonical);
+
+    // A block larger than the pool would just flush it.
+    if (bytes > maximum_size_) {
+        return false;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    if (by_hash_.find(block->hash()) != by_hash_.end()) {
+        return false;
+    }
+
+    while ( ! entries_.empty() && (size_ + bytes > maximum_size_ ||
+        entries_.size() >= maximum_count_)) {
+        erase(entries_.begin());
+    }
+
+    entries_.push_back(entry{block, bytes, sequence_++});
+    auto const it = std::prev(entries_.end());
+    by_hash_.emplace(block->hash(), it);
+    by_parent_.emplace(block->header().previous_block_hash(), it);
+    size_ += bytes;
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+block_const_ptr_list orphan_pool::remove_children(hash_digest const& parent) {
+    block_const_ptr_list children;
+
+    if ( ! enabled()) {
+        return children;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    auto const range = by_parent_.equal_range(parent);
+
+    if (range.first == range.second) {
+        return children;
+    }
+
+    std::vector<entries::iterator> found;
+
+    for (auto child = range.first; child != range.second; ++child) {
+        found.push_back(child->second);
+    }
+
+    // The multimap does not preserve the order of arrival.
+    std::sort(found.begin(), found.end(), [](entries::iterator left, entries::iterator right) {
+        return left->sequence < right->sequence;
+    });
+
+    children.reserve(found.size());
+
+    for (auto const it : found) {
+        children.push_back(it->block);
+        erase(it);
+    }
+
+    return children;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool orphan_pool::exists(hash_digest const& hash) const {
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+    return by_hash_.find(hash) != by_hash_.end();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void orphan_pool::filter(get_data_ptr message) const {
+    auto& inventories = message->inventories();
+
+    auto const pooled = [this](const libbitcoin::message::inventory_vector& inventory) {
+        return inventory.is_block_type() &&
+            by_hash_.find(inventory.hash()) != by_hash_.end();
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+    inventories.erase(std::remove_if(inventories.begin(), inventories.end(),
+        pooled), inventories.end());
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void orphan_pool::clear() {
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+    by_parent_.clear();
+    by_hash_.clear();
+    entries_.clear();
+    size_ = 0;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Properties.
+//-----------------------------------------------------------------------------
+
+size_t orphan_pool::maximum_size() const {
+    return maximum_size_;
+}
+
+size_t orphan_pool::maximum_count() const {
+    return maximum_count_;
+}
+
+size_t orphan_pool::size() const {
+    shared_lock lock(mutex_);
+    return size_;
+}
+
+size_t orphan_pool::count() const {
+    shared_lock lock(mutex_);
+    return entries_.size();
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
@@ -0,0 +1,229 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/pools/short_id_index.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <boost/thread/latch.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+// BIP152 short ids are the low six bytes of the SipHash.
+static constexpr uint64_t short_id_mask = 0xffffffffffff;
+
+// Below this many hashes per thread the dispatch costs more than it saves.
+static constexpr size_t minimum_bucket = 4096;
+
+// SipHash-2-4 over 32 byte messages (as sip_hash_uint256), one hash per
+// lane. Each step is a loop over independent lanes, which the compiler
+// turns into vector instructions where the target has them.
+//-----------------------------------------------------------------------------
+
+typedef uint64_t lane_t[short_id_index::lanes];
+
+#define FOR_EACH_LANE(statement) \
+    for (size_t lane = 0; lane < short_id_index::lanes; ++lane) { statement; }
+
+static inline void rotate(lane_t& value, int bits) {
+    FOR_EACH_LANE(value[lane] = (value[lane] << bits) | (value[lane] >> (64 - bits)))
+}
+
+static inline void sip_round(lane_t& v0, lane_t& v1, lane_t& v2, lane_t& v3) {
+    FOR_EACH_LANE(v0[lane] += v1[lane]) rotate(v1, 13);
+    FOR_EACH_LANE(v1[lane] ^= v0[lane]) rotate(v0, 32);
+    FOR_EACH_LANE(v2[lane] += v3[lane]) rotate(v3, 16);
+    FOR_EACH_LANE(v3[lane] ^= v2[lane])
+    FOR_EACH_LANE(v0[lane] += v3[lane]) rotate(v3, 21);
+    FOR_EACH_LANE(v3[lane] ^= v0[lane])
+    FOR_EACH_LANE(v2[lane] += v1[lane]) rotate(v1, 17);
+    FOR_EACH_LANE(v1[lane] ^= v2[lane]) rotate(v2, 32);
+}
+
+static void sip_hash_lanes(uint64_t k0, uint64_t k1, hash_digest const* hashes,
+    uint64_t* out) {
+    lane_t v0, v1, v2, v3, word;
+    FOR_EACH_LANE(v0[lane] = 0x736f6d6570736575ULL ^ k0)
+    FOR_EACH_LANE(v1[lane] = 0x646f72616e646f6dULL ^ k1)
+    FOR_EACH_LANE(v2[lane] = 0x6c7967656e657261ULL ^ k0)
+    FOR_EACH_LANE(v3[lane] = 0x7465646279746573ULL ^ k1)
+
+    for (size_t offset = 0; offset < hash_size; offset += sizeof(uint64_t)) {
+        FOR_EACH_LANE(word[lane] = from_little_endian_unsafe<uint64_t>(
+            hashes[lane].begin() + offset))
+        FOR_EACH_LANE(v3[lane] ^= word[lane])
+        sip_round(v0, v1, v2, v3);
+        sip_round(v0, v1, v2, v3);
+        FOR_EACH_LANE(v0[lane] ^= word[lane])
+    }
+
+    FOR_EACH_LANE(v3[lane] ^= uint64_t(hash_size) << 56)
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    FOR_EACH_LANE(v0[lane] ^= uint64_t(hash_size) << 56)
+    FOR_EACH_LANE(v2[lane] ^= 0xff)
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+
+    FOR_EACH_LANE(out[lane] = (v0[lane] ^ v1[lane] ^ v2[lane] ^ v3[lane]) &
+        short_id_mask)
+}
+
+#undef FOR_EACH_LANE
+
+// static
+void short_id_index::sip_hash(uint64_t k0, uint64_t k1,
+    hash_digest const* hashes, size_t count, uint64_t* out) {
+    auto const full = count - count % lanes;
+
+    for (size_t index = 0; index < full; index += lanes) {
+        sip_hash_lanes(k0, k1, hashes + index, out + index);
+    }
+
+    // The tail is padded to a full set of lanes.
+    if (full != count) {
+        hash_digest tail[lanes] = {};
+        uint64_t tail_out[lanes];
+        std::copy(hashes + full, hashes + count, tail);
+        sip_hash_lanes(k0, k1, tail, tail_out);
+        std::copy(tail_out, tail_out + (count - full), out + full);
+    }
+}
+
+// Pool maintenance.
+//-----------------------------------------------------------------------------
+
+void short_id_index::reset(hash_list const& hashes, hash_list const& txids) {
+    BITCOIN_ASSERT(hashes.size() == txids.size());
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    hashes_.clear();
+    txids_.clear();
+    positions_.clear();
+    hashes_.reserve(hashes.size());
+    txids_.reserve(txids.size());
+    positions_.reserve(txids.size());
+
+    for (size_t index = 0; index < txids.size(); ++index) {
+        if (positions_.emplace(txids[index], hashes_.size()).second) {
+            hashes_.push_back(hashes[index]);
+            txids_.push_back(txids[index]);
+        }
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void short_id_index::add(hash_digest const& hash, hash_digest const& txid) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    if (positions_.emplace(txid, hashes_.size()).second) {
+        hashes_.push_back(hash);
+        txids_.push_back(txid);
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void short_id_index::remove(hash_list const& txids) {
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    for (auto const& txid: txids) {
+        auto const it = positions_.find(txid);
+        if (it == positions_.end()) {
+            continue;
+        }
+
+        // Move the last entry into the hole to keep the array contiguous.
+        auto const position = it->second;
+        auto const last = hashes_.size() - 1;
+        positions_.erase(it);
+
+        if (position != last) {
+            hashes_[position] = hashes_[last];
+            txids_[position] = txids_[last];
+            positions_[txids_[position]] = position;
+        }
+
+        hashes_.pop_back();
+        txids_.pop_back();
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Matching.
+//-----------------------------------------------------------------------------
+
+void short_id_index::short_ids(uint64_t k0, uint64_t k1, dispatcher& dispatch,
+    short_id_list& out_ids, hash_list& out_txids) const {
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+
+    auto const count = hashes_.size();
+    out_ids.resize(count);
+    out_txids = txids_;
+
+    auto const buckets = std::max(size_t(1), std::min(dispatch.size(),
+        count / minimum_bucket));
+
+    // Bucket sizes are multiples of the lanes except for the last, rounded up
+    // so that the buckets cover the remainder of the division.
+    auto const bucket_size = ((count + buckets - 1) / buckets + lanes - 1) /
+        lanes * lanes;
+
+    auto const hash_bucket = [&](size_t bucket) {
+        auto const first = std::min(count, bucket * bucket_size);
+        auto const last = std::min(count, first + bucket_size);
+        sip_hash(k0, k1, hashes_.data() + first, last - first,
+            out_ids.data() + first);
+    };
+
+    // The caller hashes the first bucket while the others are dispatched.
+    boost::latch latch(buckets);
+
+    for (size_t bucket = 1; bucket < buckets; ++bucket) {
+        dispatch.concurrent([&hash_bucket, &latch, bucket]() {
+            hash_bucket(bucket);
+            latch.count_down();
+        });
+    }
+
+    hash_bucket(0);
+    latch.count_down_and_wait();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+size_t short_id_index::size() const {
+    shared_lock lock(mutex_);
+    return hashes_.size();
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
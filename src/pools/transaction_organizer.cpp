@@ -41,9 +41,9 @@ using namespace std::placeholders;
 // TODO: create priority pool at blockchain level and use in both organizers. 
 
 #if defined(BITPRIM_WITH_MEMPOOL)
-transaction_organizer::transaction_organizer(prioritized_mutex& mutex, dispatcher& dispatch, threadpool& thread_pool, fast_chain& chain, const settings& settings, mining::mempool& mp)
+transaction_organizer::transaction_organizer(prioritized_mutex& mutex, dispatcher& dispatch, chain_notifier& notifier, fast_chain& chain, const settings& settings, script_cache& cache, mining::mempool& mp)
 #else
-transaction_organizer::transaction_organizer(prioritized_mutex& mutex, dispatcher& dispatch, threadpool& thread_pool, fast_chain& chain, const settings& settings)
+transaction_organizer::transaction_organizer(prioritized_mutex& mutex, dispatcher& dispatch, chain_notifier& notifier, fast_chain& chain, const settings& settings, script_cache& cache)
 #endif
     : fast_chain_(chain)
     , mutex_(mutex)
@@ -53,12 +53,12 @@ transaction_organizer::transaction_organizer(prioritized_mutex& mutex, dispatche
     , transaction_pool_(settings)
 
 #if defined(BITPRIM_WITH_MEMPOOL)
-    , validator_(dispatch, fast_chain_, settings, mp)
+    , validator_(dispatch, fast_chain_, settings, cache, mp)
 #else
-    , validator_(dispatch, fast_chain_, settings)
+    , validator_(dispatch, fast_chain_, settings, cache)
 #endif
 
-    , subscriber_(std::make_shared<transaction_subscriber>(thread_pool, NAME))
+    , notifier_(notifier)
 
 #if defined(BITPRIM_WITH_MEMPOOL)
     , mempool_(mp)
@@ -79,7 +79,6 @@ bool transaction_organizer::stopped() const
 bool transaction_organizer::start()
 {
     stopped_ = false;
-    subscriber_->start();
     validator_.start();
     return true;
 }
@@ -87,8 +86,6 @@ bool transaction_organizer::start()
 bool transaction_organizer::stop()
 {
     validator_.stop();
-    subscriber_->stop();
-    subscriber_->invoke(error::service_stopped, {});
     stopped_ = true;
     return true;
 }
@@ -343,18 +340,18 @@ void transaction_organizer::handle_pushed(const code& ec,
 // private
 void transaction_organizer::notify(transaction_const_ptr tx)
 {
-    // This invokes handlers within the criticial section (deadlock risk).
-    subscriber_->invoke(error::success, tx);
+    // This queues the notification, handlers are invoked by the notifier.
+    notifier_.notify(tx);
 }
 
 void transaction_organizer::subscribe(transaction_handler&& handler)
 {
-    subscriber_->subscribe(std::move(handler), error::service_stopped, {});
+    notifier_.subscribe_transaction(std::move(handler));
 }
 
 void transaction_organizer::unsubscribe()
 {
-    subscriber_->relay(error::success, {});
+    notifier_.unsubscribe_transaction();
 }
 
 // Queries.
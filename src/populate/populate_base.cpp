@@ -133,5 +133,48 @@ void populate_base::populate_prevout(size_t branch_height, output_point const& o
     }
 }
 
+void populate_base::populate_prevouts(size_t branch_height, const fast_chain::output_point_ptr_list& outpoints, bool require_confirmed) const {
+#if defined(BITPRIM_DB_NEW)
+    fast_chain::output_point_ptr_list lookups;
+    lookups.reserve(outpoints.size());
+
+    for (auto const outpoint : outpoints) {
+        auto& prevout = outpoint->validation;
+        prevout.spent = false;
+        prevout.confirmed = false;
+        prevout.cache = chain::output{};
+        prevout.from_mempool = false;
+
+        // If the input is a coinbase there is no prevout to populate.
+        if ( ! outpoint->is_null()) {
+            lookups.push_back(outpoint);
+        }
+    }
+
+    // A single ordered pass over the UTXO Set.
+    fast_chain_.get_utxos(lookups, branch_height);
+
+    for (auto const outpoint : lookups) {
+        auto& prevout = outpoint->validation;
+
+        if ( ! prevout.cache.is_valid()) {
+            continue;
+        }
+
+        // The previous output has already been spent (double spend).
+        const auto spend_height = prevout.cache.validation.spender_height;
+        if ((spend_height <= branch_height) && (spend_height != output::validation::not_spent)) {
+            prevout.spent = true;
+            prevout.confirmed = true;
+            prevout.cache = chain::output{};
+        }
+    }
+#else
+    for (auto const outpoint : outpoints) {
+        populate_prevout(branch_height, *outpoint, require_confirmed);
+    }
+#endif // BITPRIM_DB_NEW
+}
+
 } // namespace blockchain
 } // namespace libbitcoin
@@ -21,9 +21,12 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <iterator>
+#include <memory>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
+#include <bitcoin/blockchain/validate/input_scheduler.hpp>
 
 namespace libbitcoin {
 namespace blockchain {
@@ -82,14 +85,43 @@ void populate_block::populate(branch::const_ptr branch, result_handler&& handler
     auto branch_utxo = create_branch_utxo_set(branch);
 
 #if defined(BITPRIM_WITH_MEMPOOL)
+    // Shared snapshot, the buckets just copy the pointer.
     auto validated_txs = mempool_.get_validated_txs_high();
 #endif
 
+    auto const& txs = block->transactions();
+    auto const prevouts = std::make_shared<fast_chain::output_point_ptr_list>();
+    prevouts->reserve(non_coinbase_inputs);
+
+    // Must skip coinbase here as it is already accounted for.
+    for (size_t position = 1; position < txs.size(); ++position) {
+        auto const& tx = txs[position];
+
+#if defined(BITPRIM_WITH_MEMPOOL)
+        // The prevouts of these are copied from the mempool (by tx, not by input).
+        if (validated_txs->find(tx.hash()) != validated_txs->end()) {
+            continue;
+        }
+#endif
+        for (auto const& input : tx.inputs()) {
+            prevouts->push_back(&input.previous_output());
+        }
+    }
+
+    // Sorted by key, each thread reads a contiguous range of the store.
+    std::sort(prevouts->begin(), prevouts->end(), [](output_point const* a, output_point const* b) {
+        return *a < *b;
+    });
+
+    auto const work = std::make_shared<input_scheduler>();
+    work->add(0, prevouts->size());
+    work->distribute(buckets);
+
     for (size_t bucket = 0; bucket < buckets; ++bucket) {
 #if defined(BITPRIM_WITH_MEMPOOL)
-        dispatch_.concurrent(&populate_block::populate_transactions, this, branch, bucket, buckets, branch_utxo, validated_txs, join_handler);
+        dispatch_.concurrent(&populate_block::populate_transactions, this, branch, bucket, buckets, branch_utxo, validated_txs, prevouts, work, join_handler);
 #else
-        dispatch_.concurrent(&populate_block::populate_transactions, this, branch, bucket, buckets, branch_utxo, join_handler);
+        dispatch_.concurrent(&populate_block::populate_transactions, this, branch, bucket, buckets, branch_utxo, prevouts, work, join_handler);
 #endif
     }
 }
@@ -161,35 +193,25 @@ populate_block::utxo_pool_t populate_block::get_reorg_subset_conditionally(size_
 
 
 #if defined(BITPRIM_DB_NEW)
-void populate_block::populate_transaction_inputs(branch::const_ptr branch, chain::input::list const& inputs, size_t bucket, size_t buckets, size_t input_position, local_utxo_set_t const& branch_utxo, size_t first_height, size_t chain_top, utxo_pool_t const& reorg_subset) const {
+void populate_block::populate_transaction_input(branch::const_ptr branch, output_point const& prevout, local_utxo_set_t const& branch_utxo, size_t first_height, size_t chain_top, utxo_pool_t const& reorg_subset) const {
 #else
-void populate_block::populate_transaction_inputs(branch::const_ptr branch, chain::input::list const& inputs, size_t bucket, size_t buckets, size_t input_position, local_utxo_set_t const& branch_utxo) const {
+void populate_block::populate_transaction_input(branch::const_ptr branch, output_point const& prevout, local_utxo_set_t const& branch_utxo) const {
 #endif
 
-    auto const branch_height = branch->height();
-
-    for (size_t input_index = 0; input_index < inputs.size(); ++input_index, ++input_position) {
-        if (input_position % buckets != bucket) {
-            continue;
-        }
-
-        auto const& input = inputs[input_index];
-        auto const& prevout = input.previous_output();
-        populate_base::populate_prevout(branch_height, prevout, true);  //Populate from Database
-        populate_prevout(branch, prevout, branch_utxo);                 //Populate from the Blocks in the Branch
+    // The database part is populated in bulk by the caller.
+    populate_prevout(branch, prevout, branch_utxo);                     //Populate from the Blocks in the Branch
 
 #if defined(BITPRIM_DB_NEW)
-        if (first_height <= chain_top) {
-            populate_from_reorg_subset(prevout, reorg_subset);
-        }
-#endif // BITPRIM_DB_NEW
+    if (first_height <= chain_top) {
+        populate_from_reorg_subset(prevout, reorg_subset);
     }
+#endif // BITPRIM_DB_NEW
 }
 
 #if defined(BITPRIM_WITH_MEMPOOL)
-void populate_block::populate_transactions(branch::const_ptr branch, size_t bucket, size_t buckets, local_utxo_set_t const& branch_utxo, mining::mempool::hash_index_t const& validated_txs, result_handler handler) const {
+void populate_block::populate_transactions(branch::const_ptr branch, size_t bucket, size_t buckets, local_utxo_set_t const& branch_utxo, mining::mempool::validated_txs_ptr_t const& validated_txs, output_point_ptr_list_ptr prevouts, input_scheduler::ptr work, result_handler handler) const {
 #else
-void populate_block::populate_transactions(branch::const_ptr branch, size_t bucket, size_t buckets, local_utxo_set_t const& branch_utxo, result_handler handler) const {
+void populate_block::populate_transactions(branch::const_ptr branch, size_t bucket, size_t buckets, local_utxo_set_t const& branch_utxo, output_point_ptr_list_ptr prevouts, input_scheduler::ptr work, result_handler handler) const {
 #endif
     // TODO(fernando): check how to replace it with UTXO
     // asm("int $3");  //TODO(fernando): remover
@@ -198,7 +220,6 @@ void populate_block::populate_transactions(branch::const_ptr branch, size_t buck
     auto const block = branch->top();
     auto const branch_height = branch->height();
     auto const& txs = block->transactions();
-    size_t input_position = 0;
 
     auto const state = block->validation.state;
     auto const forks = state->enabled_forks();
@@ -237,6 +258,17 @@ void populate_block::populate_transactions(branch::const_ptr branch, size_t buck
             ////populate_duplicate(branch, coinbase);
         }
 #endif
+
+#if defined(BITPRIM_WITH_MEMPOOL)
+        auto it = validated_txs->find(tx.hash());
+        if (it != validated_txs->end()) {
+            tx.validation.validated = true;
+            auto const& tx_cached = *it->second;
+            for (size_t i = 0; i < tx_cached.inputs().size(); ++i) {
+                tx.inputs()[i].previous_output().validation = tx_cached.inputs()[i].previous_output().validation;
+            }
+        }
+#endif // defined(BITPRIM_WITH_MEMPOOL)
     }
 
 #if defined(BITPRIM_DB_NEW)
@@ -246,33 +278,23 @@ void populate_block::populate_transactions(branch::const_ptr branch, size_t buck
 #endif // BITPRIM_DB_NEW
 
 
-    // Must skip coinbase here as it is already accounted for.
-    for (auto tx = txs.begin() + 1; tx != txs.end(); ++tx) {
+    // The sorted prevouts are pulled in chunks, the work is balanced among
+    // the threads and each chunk is a single ordered pass over the store.
+    size_t first_input;
+    size_t last_input;
 
-#if defined(BITPRIM_WITH_MEMPOOL)
-        auto it = validated_txs.find(tx->hash());
-        if (it == validated_txs.end()) {
-            auto const& inputs = tx->inputs();
+    while (work->next(first_input, last_input)) {
+        fast_chain::output_point_ptr_list const chunk(std::next(prevouts->begin(), first_input), std::next(prevouts->begin(), last_input));
+
+        populate_base::populate_prevouts(branch_height, chunk, true);   //Populate from Database
+
+        for (auto const prevout : chunk) {
 #if defined(BITPRIM_DB_NEW)
-            populate_transaction_inputs(branch, inputs, bucket, buckets, input_position, branch_utxo, first_height, chain_top, reorg_subset);
+            populate_transaction_input(branch, *prevout, branch_utxo, first_height, chain_top, reorg_subset);
 #else
-            populate_transaction_inputs(branch, inputs, bucket, buckets, input_position, branch_utxo);
+            populate_transaction_input(branch, *prevout, branch_utxo);
 #endif
-        } else {
-            tx->validation.validated = true;
-            auto const& tx_cached = it->second.second;
-            for (size_t i = 0; i < tx_cached.inputs().size(); ++i) {
-                tx->inputs()[i].previous_output().validation = tx_cached.inputs()[i].previous_output().validation;
-            }
         }
-#else
-        auto const& inputs = tx->inputs();
-#if defined(BITPRIM_DB_NEW)
-        populate_transaction_inputs(branch, inputs, bucket, buckets, input_position, branch_utxo, first_height, chain_top, reorg_subset);
-#else
-        populate_transaction_inputs(branch, inputs, bucket, buckets, input_position, branch_utxo);
-#endif
-#endif // defined(BITPRIM_WITH_MEMPOOL)
     }
 
     handler(error::success);
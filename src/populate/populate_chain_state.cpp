@@ -181,10 +181,6 @@ bool populate_chain_state::populate_bip9_bit1(chain_state::data& data,
 bool populate_chain_state::populate_all(chain_state::data& data,
     branch::const_ptr branch) const
 {
-    // Critical Section
-    ///////////////////////////////////////////////////////////////////////////
-    unique_lock lock(mutex_);
-
     // Construct a map to inform chain state data population.
     auto const map = chain_state::get_map(data.height, checkpoints_, configured_forks_);
 
@@ -194,7 +190,27 @@ bool populate_chain_state::populate_all(chain_state::data& data,
         populate_collision(data, map, branch) &&
         populate_bip9_bit0(data, map, branch) &&
         populate_bip9_bit1(data, map, branch));
-    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+// Slide the windows from the state of the parent of the top block, which is
+// set on a branch block when it is validated (pooled blocks retain it).
+chain_state::ptr populate_chain_state::promote(branch::const_ptr branch) const {
+    auto const& blocks = *branch->blocks();
+
+    if (blocks.size() < 2) {
+        return {};
+    }
+
+    auto const parent_state = blocks[blocks.size() - 2]->validation.state;
+
+    if ( ! parent_state || parent_state->height() + 1 != branch->top_height()) {
+        return {};
+    }
+
+    // The pool state that follows the parent, then the top block state.
+    chain_state const pool(*parent_state);
+    return std::make_shared<chain_state>(pool, *branch->top());
 }
 
 chain_state::ptr populate_chain_state::populate() const {
@@ -231,6 +247,14 @@ chain_state::ptr populate_chain_state::populate(chain_state::ptr pool, branch::c
     if (branch->size() == 1 && branch->top_height() == pool->height())
         return std::make_shared<chain_state>(*pool, *block);
 
+    // If the parent is a validated branch block we can promote its state.
+    auto const promoted = promote(branch);
+    if (promoted) {
+        return promoted;
+    }
+
+    // Otherwise this is a reorganization from a confirmed block below the top.
+
     chain_state::data data;
     data.hash = block->hash();
     data.height = branch->top_height();
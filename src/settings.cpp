@@ -67,6 +67,16 @@ settings::settings()
     , bip147(true)
 #endif
 
+    , script_cache_size(262144)
+    , block_cache_size(64 * 1024 * 1024)
+    , compact_block_cache_count(16)
+    , orphan_pool_size(64 * 1024 * 1024)
+    , orphan_pool_count(512)
+    , organize_queue_blocks(64)
+    , organize_queue_transactions(4096)
+    , notification_queue_limit(1024)
+    , notification_window_milliseconds(0)
+
 #if defined(BITPRIM_WITH_MEMPOOL)
     , mempool_max_template_size(mining::mempool::max_template_size_default)
     , mempool_size_multiplier(mining::mempool::mempool_size_multiplier_default)
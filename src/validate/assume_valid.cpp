@@ -0,0 +1,144 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/validate/assume_valid.hpp>
+
+#include <cstddef>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+assume_valid::assume_valid(config::checkpoint const& checkpoint)
+    : checkpoint_(checkpoint)
+    , cursor_(checkpoint.hash())
+    , sequence_(0)
+{}
+
+bool assume_valid::enabled() const {
+    return checkpoint_.hash() != null_hash;
+}
+
+// private, call under unique lock.
+size_t assume_valid::link() {
+    size_t count = 0;
+
+    for (auto it = unlinked_.find(cursor_); it != unlinked_.end();
+        it = unlinked_.find(cursor_)) {
+        path_.insert(cursor_);
+        cursor_ = it->second.parent;
+        arrivals_.erase(it->second.sequence);
+        unlinked_.erase(it);
+        ++count;
+    }
+
+    // Nothing below the genesis block can link, release the remainder.
+    if (cursor_ == null_hash) {
+        unlinked_.clear();
+        arrivals_.clear();
+    }
+
+    return count;
+}
+
+// private, call under unique lock.
+// The headers are sent by peers, and the assumed header may never arrive (or
+// side branches may), so no more are retained than the path still lacks. An
+// evicted path header stops linking at its height, the blocks below it are
+// then fully validated.
+void assume_valid::evict() {
+    auto const height = checkpoint_.height();
+    auto const lacking = height < path_.size() ? size_t(0) : height + 1 - path_.size();
+
+    while (unlinked_.size() > lacking) {
+        auto const oldest = arrivals_.begin();
+        unlinked_.erase(oldest->second);
+        arrivals_.erase(oldest);
+    }
+}
+
+size_t assume_valid::add(chain::header::list const& headers) {
+    if ( ! enabled() || headers.empty()) {
+        return 0;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(mutex_);
+
+    if (cursor_ == null_hash) {
+        return 0;
+    }
+
+    for (auto const& header : headers) {
+        auto const hash = header.hash();
+
+        if (path_.find(hash) == path_.end() &&
+            unlinked_.emplace(hash, unlinked_header{header.previous_block_hash(), sequence_}).second) {
+            arrivals_.emplace(sequence_++, hash);
+        }
+    }
+
+    auto const count = link();
+    evict();
+    return count;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool assume_valid::contains(hash_digest const& hash) const {
+    if ( ! enabled()) {
+        return false;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+    return path_.find(hash) != path_.end();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool assume_valid::complete() const {
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+    return enabled() && cursor_ == null_hash;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+config::checkpoint const& assume_valid::checkpoint() const {
+    return checkpoint_;
+}
+
+size_t assume_valid::linked() const {
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+    return path_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+size_t assume_valid::pending() const {
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    shared_lock lock(mutex_);
+    return unlinked_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
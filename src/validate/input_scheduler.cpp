@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/validate/input_scheduler.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+// Chunks are small enough to balance skewed blocks (one giant tx is split
+// among all the threads) and big enough to keep the shared counter cold.
+static constexpr size_t minimum_chunk = 8;
+static constexpr size_t chunks_per_worker = 16;
+
+input_scheduler::input_scheduler()
+    : offsets_{0}
+    , chunk_(minimum_chunk)
+    , next_(0)
+    , cancelled_(false)
+{}
+
+void input_scheduler::add(size_t position, size_t inputs) {
+    if (inputs == 0) {
+        return;
+    }
+
+    positions_.push_back(position);
+    offsets_.push_back(offsets_.back() + inputs);
+}
+
+void input_scheduler::distribute(size_t workers) {
+    auto const divisor = std::max(size_t(1), workers) * chunks_per_worker;
+    chunk_ = std::max(minimum_chunk, size() / divisor);
+}
+
+size_t input_scheduler::size() const {
+    return offsets_.back();
+}
+
+size_t input_scheduler::transactions() const {
+    return positions_.size();
+}
+
+bool input_scheduler::next(size_t& first, size_t& last) {
+    if (cancelled_) {
+        return false;
+    }
+
+    auto const total = size();
+    first = next_.fetch_add(chunk_);
+
+    if (first >= total) {
+        return false;
+    }
+
+    last = std::min(first + chunk_, total);
+    return true;
+}
+
+void input_scheduler::cancel() {
+    cancelled_ = true;
+}
+
+bool input_scheduler::cancelled() const {
+    return cancelled_;
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
@@ -0,0 +1,131 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/blockchain/validate/script_cache.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace blockchain {
+
+// Independent locks, to reduce contention between validation threads.
+static constexpr size_t shard_count = 16;
+
+script_cache::script_cache(size_t capacity)
+    : capacity_(capacity)
+    , shard_capacity_(capacity == 0 ? 0 : std::max(size_t(1), capacity / shard_count))
+    , shards_(capacity == 0 ? 0 : shard_count)
+    , hits_(0)
+    , misses_(0)
+    , evictions_(0)
+{}
+
+size_t script_cache::key_hasher::operator()(key const& x) const {
+    // The tx hash is uniformly distributed, its leading bytes are enough.
+    auto const seed = from_little_endian_unsafe<uint64_t>(x.hash.begin());
+    return static_cast<size_t>(seed ^ (uint64_t(x.index) << 32) ^ x.forks);
+}
+
+script_cache::shard& script_cache::get_shard(key const& x) const {
+    // Use bytes not consumed by key_hasher to pick the shard.
+    return shards_[x.hash[hash_size - 1] % shards_.size()];
+}
+
+bool script_cache::enabled() const {
+    return capacity_ != 0;
+}
+
+bool script_cache::contains(hash_digest const& tx_hash, uint32_t input_index, uint32_t forks) const {
+    if ( ! enabled()) {
+        return false;
+    }
+
+    key const x {tx_hash, input_index, forks};
+    auto& bucket = get_shard(x);
+
+    bool found;
+    {
+        shared_lock lock(bucket.mutex);
+        found = bucket.entries.find(x) != bucket.entries.end();
+    }
+
+    ++(found ? hits_ : misses_);
+    return found;
+}
+
+void script_cache::add(hash_digest const& tx_hash, uint32_t input_index, uint32_t forks) {
+    if ( ! enabled()) {
+        return;
+    }
+
+    key const x {tx_hash, input_index, forks};
+    auto& bucket = get_shard(x);
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Critical Section
+    unique_lock lock(bucket.mutex);
+
+    if ( ! bucket.entries.insert(x).second) {
+        return;
+    }
+
+    bucket.order.push_back(x);
+
+    while (bucket.entries.size() > shard_capacity_) {
+        bucket.entries.erase(bucket.order.front());
+        bucket.order.pop_front();
+        ++evictions_;
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Properties.
+//-----------------------------------------------------------------------------
+
+size_t script_cache::capacity() const {
+    return capacity_;
+}
+
+size_t script_cache::size() const {
+    size_t result = 0;
+
+    for (auto const& bucket : shards_) {
+        shared_lock lock(bucket.mutex);
+        result += bucket.entries.size();
+    }
+
+    return result;
+}
+
+size_t script_cache::hits() const {
+    return hits_;
+}
+
+size_t script_cache::misses() const {
+    return misses_;
+}
+
+size_t script_cache::evictions() const {
+    return evictions_;
+}
+
+} // namespace blockchain
+} // namespace libbitcoin
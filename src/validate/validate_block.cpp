@@ -29,6 +29,7 @@
 #include <bitcoin/blockchain/interface/fast_chain.hpp>
 #include <bitcoin/blockchain/pools/branch.hpp>
 #include <bitcoin/blockchain/settings.hpp>
+#include <bitcoin/blockchain/validate/input_scheduler.hpp>
 #include <bitcoin/blockchain/validate/validate_input.hpp>
 
 namespace libbitcoin {
@@ -49,13 +50,14 @@ using namespace std::placeholders;
 // will never be invoked, resulting in a threadpool.join indefinite hang.
 
 #if defined(BITPRIM_WITH_MEMPOOL)
-validate_block::validate_block(dispatcher& dispatch, const fast_chain& chain, const settings& settings, bool relay_transactions, mining::mempool const& mp)
+validate_block::validate_block(dispatcher& dispatch, const fast_chain& chain, const settings& settings, script_cache& cache, bool relay_transactions, mining::mempool const& mp)
 #else
-validate_block::validate_block(dispatcher& dispatch, const fast_chain& chain, const settings& settings, bool relay_transactions)
+validate_block::validate_block(dispatcher& dispatch, const fast_chain& chain, const settings& settings, script_cache& cache, bool relay_transactions)
 #endif    
     : stopped_(true)
     , fast_chain_(chain)
     , priority_dispatch_(dispatch)
+    , script_cache_(cache)
 #if defined(BITPRIM_WITH_MEMPOOL)
     , block_populator_(dispatch, chain, relay_transactions, mp)
 #else
@@ -93,9 +95,10 @@ void validate_block::check(block_const_ptr block, result_handler handler) const
         std::bind(&validate_block::handle_checked,
             this, _1, block, handler);
 
-    // TODO: make configurable for each parallel segment.
-    // This one is more efficient with one thread than parallel.
-    const auto threads = std::min(size_t(1), priority_dispatch_.size());
+    // Hashing dominates the context free checks of large blocks, so it is
+    // fanned out to the whole pool. The hashes are cached in the txs and
+    // reused by the merkle root and the remaining (serial) block checks.
+    const auto threads = priority_dispatch_.size();
 
     const auto count = block->transactions().size();
     const auto buckets = std::min(threads, count);
@@ -312,80 +315,114 @@ void validate_block::connect(branch::const_ptr branch,
         return;
     }
 
-    // Reset statistics for each block (treat coinbase as cached).
-    hits_ = 0;
-    queries_ = 0;
+    const auto& txs = block->transactions();
+    const auto work = std::make_shared<input_scheduler>();
+
+    // Must skip coinbase here as it is already accounted for.
+    for (size_t position = 1; position < txs.size(); ++position) {
+        const auto& tx = txs[position];
+
+        // The tx is pooled with current fork state so outputs are validated.
+        // The tx was validated before its insertion in the mempool.
+        // TODO(fernando): what happend with Blockchain forks?
+        if ( ! tx.validation.current && ! tx.validation.validated) {
+            work->add(position, tx.inputs().size());
+        }
+    }
+
+    // Inputs are still required to be populated, but not their scripts.
+    const auto verify_scripts = ! is_assumed_valid(*block);
+
+    // Statistics for each block (treat coinbase as cached).
+    queries_ = txs.size() - 1;
+    hits_ = queries_ - work->transactions();
 
     result_handler complete_handler =
         std::bind(&validate_block::handle_connected,
             this, _1, block, handler);
 
+    // Return if all the transactions were already validated.
+    if (work->size() == 0) {
+        complete_handler(error::success);
+        return;
+    }
+
     const auto threads = priority_dispatch_.size();
-    const auto buckets = std::min(threads, non_coinbase_inputs);
+    const auto buckets = std::min(threads, work->size());
     BITCOIN_ASSERT(buckets != 0);
+    work->distribute(buckets);
 
     const auto join_handler = synchronize(std::move(complete_handler), buckets,
         NAME "_validate");
 
     for (size_t bucket = 0; bucket < buckets; ++bucket)
         priority_dispatch_.concurrent(&validate_block::connect_inputs,
-            this, block, bucket, buckets, join_handler);
+            this, block, work, verify_scripts, join_handler);
 }
 
-void validate_block::connect_inputs(block_const_ptr block, size_t bucket,
-    size_t buckets, result_handler handler) const
+// Scripts are skipped only for blocks proven (by header hash linkage) to be
+// the assume valid block or one of its ancestors. A block on any other branch,
+// including one at the assumed height, is fully verified and does not affect
+// the trust of the assumed path.
+bool validate_block::is_assumed_valid(const chain::block& block) const
+{
+    return fast_chain_.is_assumed_valid(block.hash());
+}
+
+void validate_block::connect_inputs(block_const_ptr block,
+    input_scheduler::ptr work, bool verify_scripts,
+    result_handler handler) const
 {
-    BITCOIN_ASSERT(bucket < buckets);
     code ec(error::success);
     const auto forks = block->validation.state->enabled_forks();
     const auto& txs = block->transactions();
-    size_t position = 0;
 
-    // Must skip coinbase here as it is already accounted for.
-    for (auto tx = txs.begin() + 1; tx != txs.end(); ++tx) {
-        ++queries_;
+    // Serialized lazily, once per transaction in a row pulled by this thread.
+    // The coinbase (position zero) is never scheduled.
+    size_t tx_data_position = 0;
+    data_chunk tx_data;
 
-        // The tx is pooled with current fork state so outputs are validated.
-        if (tx->validation.current) {
-            ++hits_;
-            continue;
+    const auto verify = [&](size_t position, uint32_t input_index) {
+        if (stopped()) {
+            ec = error::service_stopped;
+            return false;
         }
 
-        // The tx was validated before its insertion in the mempool
-        // TODO(fernando): what happend with Blockchain forks?
-        if (tx->validation.validated) {
-            ++hits_;
-            continue;
-        }
-
-
-        size_t input_index;
-        const auto& inputs = tx->inputs();
-
-        for (input_index = 0; input_index < inputs.size(); ++input_index, ++position) {
-            if (position % buckets != bucket)
-                continue;
+        const auto& tx = txs[position];
+        const auto& prevout = tx.inputs()[input_index].previous_output();
 
-            if (stopped()) {
-                handler(error::service_stopped);
-                return;
-            }
-
-            const auto& prevout = inputs[input_index].previous_output();
-
-            if (!prevout.validation.cache.is_valid()) {
-                ec = error::missing_previous_output;
-                break;
+        if (!prevout.validation.cache.is_valid()) {
+            ec = error::missing_previous_output;
+        } else if (!verify_scripts) {
+            return true;
+        } else if (script_cache_.contains(tx.hash(true), input_index, forks)) {
+            // Already verified under the same rules, i.e. at mempool acceptance.
+            return true;
+        } else {
+            if (tx_data_position != position) {
+                tx_data = validate_input::transaction_data(tx);
+                tx_data_position = position;
             }
 
-            if ((ec = validate_input::verify_script(*tx, input_index, forks))) {
-                break;
-            }
+            ec = validate_input::verify_script(tx, tx_data, input_index, forks);
         }
 
         if (ec) {
             const auto height = block->validation.state->height();
-            dump(ec, *tx, input_index, forks, height);
+            dump(ec, tx, input_index, forks, height);
+            return false;
+        }
+
+        return true;
+    };
+
+    size_t first;
+    size_t last;
+
+    while (work->next(first, last)) {
+        if ( ! work->visit(first, last, verify)) {
+            // Cooperative early cancellation of the other threads.
+            work->cancel();
             break;
         }
     }
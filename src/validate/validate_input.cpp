@@ -189,16 +189,27 @@ code validate_input::convert_result(verify_result_type result)
     }
 }
 
-// TODO: cache transaction wire serialization.
-code validate_input::verify_script(const transaction& tx, uint32_t input_index,
-    uint32_t branches) {
-
+data_chunk validate_input::transaction_data(transaction const& tx) {
 #ifdef BITPRIM_CURRENCY_BCH
     bool witness = false;
 #else
     bool witness = true;
 #endif
 
+    //TODO(fernando): implement BITPRIM_CACHED_RPC_DATA (See bitprim-domain) for the last parameter (unconfirmed = false).
+    // return tx.to_data(true, witness, false);
+    return tx.to_data(true, witness);
+}
+
+code validate_input::verify_script(const transaction& tx, uint32_t input_index,
+    uint32_t branches) {
+    return verify_script(tx, transaction_data(tx), input_index, branches);
+}
+
+// Wire serialization is cached in support of large numbers of inputs.
+code validate_input::verify_script(const transaction& tx, data_chunk const& tx_data, 
+    uint32_t input_index, uint32_t branches) {
+
     BITCOIN_ASSERT(input_index < tx.inputs().size());
     const auto& prevout = tx.inputs()[input_index].previous_output().validation;
     const auto script_data = prevout.cache.script().to_data(false);
@@ -208,12 +219,6 @@ code validate_input::verify_script(const transaction& tx, uint32_t input_index,
     const auto amount = prevout.cache.value();
     // const auto prevout_value = prevout.cache.value();
 
-    // Wire serialization is cached in support of large numbers of inputs.
-
-    //TODO(fernando): implement BITPRIM_CACHED_RPC_DATA (See bitprim-domain) for the last parameter (unconfirmed = false).
-    // const auto tx_data = tx.to_data(true, witness, false);
-    const auto tx_data = tx.to_data(true, witness);
-
 #ifdef BITPRIM_CURRENCY_BCH
     auto res = consensus::verify_script(tx_data.data(),
         tx_data.size(), script_data.data(), script_data.size(), input_index,
@@ -234,6 +239,14 @@ code validate_input::verify_script(const transaction& tx, uint32_t input_index,
 
 #else //WITH_CONSENSUS
 
+data_chunk validate_input::transaction_data(transaction const& tx) {
+    return tx.to_data(true, true);
+}
+
+code validate_input::verify_script(transaction const& tx, data_chunk const& /*tx_data*/, uint32_t input_index, uint32_t forks) {
+    return verify_script(tx, input_index, forks);
+}
+
 code validate_input::verify_script(transaction const& tx, uint32_t input_index, uint32_t forks) {
 
 #error Not supported, build using -o with_consensus=True
@@ -47,9 +47,9 @@ using namespace std::placeholders;
 
 
 #if defined(BITPRIM_WITH_MEMPOOL)
-validate_transaction::validate_transaction(dispatcher& dispatch, const fast_chain& chain, const settings& settings, mining::mempool const& mp)
+validate_transaction::validate_transaction(dispatcher& dispatch, const fast_chain& chain, const settings& settings, script_cache& cache, mining::mempool const& mp)
 #else
-validate_transaction::validate_transaction(dispatcher& dispatch, const fast_chain& chain, const settings& settings)
+validate_transaction::validate_transaction(dispatcher& dispatch, const fast_chain& chain, const settings& settings, script_cache& cache)
 #endif
   : stopped_(true),
     retarget_(settings.retarget),
@@ -60,7 +60,8 @@ validate_transaction::validate_transaction(dispatcher& dispatch, const fast_chai
 #else
     transaction_populator_(dispatch, chain),
 #endif
-    fast_chain_(chain)
+    fast_chain_(chain),
+    script_cache_(cache)
 {
 }
 
@@ -151,14 +152,17 @@ void validate_transaction::connect(transaction_const_ptr tx,
     const auto join_handler = synchronize(handler, buckets, NAME "_validate");
     BITCOIN_ASSERT(buckets != 0);
 
+    // The wire serialization is computed once and shared by all the buckets.
+    const auto tx_data = std::make_shared<const data_chunk>(validate_input::transaction_data(*tx));
+
     // If the priority threadpool is shut down when this is called the handler
     // will never be invoked, resulting in a threadpool.join indefinite hang.
     for (size_t bucket = 0; bucket < buckets; ++bucket)
         dispatch_.concurrent(&validate_transaction::connect_inputs,
-            this, tx, bucket, buckets, join_handler);
+            this, tx, tx_data, bucket, buckets, join_handler);
 }
 
-void validate_transaction::connect_inputs(transaction_const_ptr tx, size_t bucket, size_t buckets, result_handler handler) const
+void validate_transaction::connect_inputs(transaction_const_ptr tx, tx_data_ptr tx_data, size_t bucket, size_t buckets, result_handler handler) const
 {
     BITCOIN_ASSERT(bucket < buckets);
     code ec(error::success);
@@ -178,9 +182,12 @@ void validate_transaction::connect_inputs(transaction_const_ptr tx, size_t bucke
             break;
         }
 
-        if ((ec = validate_input::verify_script(*tx, input_index, forks))) {
+        if ((ec = validate_input::verify_script(*tx, *tx_data, input_index, forks))) {
             break;
         }
+
+        // Allows the block validation to skip this script.
+        script_cache_.add(tx->hash(true), input_index, forks);
     }
 
     handler(ec);
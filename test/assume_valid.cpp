@@ -0,0 +1,186 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(assume_valid_tests)
+
+static chain::header make_header(const hash_digest& parent, uint32_t nonce)
+{
+    return chain::header{ 1, parent, null_hash, 0, 0, nonce };
+}
+
+// Genesis (parent null) followed by count - 1 linked headers.
+static chain::header::list make_chain(size_t count)
+{
+    chain::header::list headers;
+    auto parent = null_hash;
+
+    for (size_t height = 0; height < count; ++height)
+    {
+        headers.push_back(make_header(parent, 42));
+        parent = headers.back().hash();
+    }
+
+    return headers;
+}
+
+// construct
+
+BOOST_AUTO_TEST_CASE(assume_valid__construct__null_hash__disabled)
+{
+    const auto headers = make_chain(4);
+    assume_valid instance(config::checkpoint{ null_hash, 3 });
+    BOOST_REQUIRE(!instance.enabled());
+    BOOST_REQUIRE_EQUAL(instance.add(headers), 0u);
+    BOOST_REQUIRE(!instance.contains(headers[0].hash()));
+    BOOST_REQUIRE(!instance.complete());
+}
+
+// add/contains
+
+BOOST_AUTO_TEST_CASE(assume_valid__add__linked_chain__skips_ancestors)
+{
+    const auto headers = make_chain(4);
+    assume_valid instance(config::checkpoint{ headers[3].hash(), 3 });
+    BOOST_REQUIRE(instance.enabled());
+    BOOST_REQUIRE_EQUAL(instance.add(headers), 4u);
+    BOOST_REQUIRE(instance.complete());
+    BOOST_REQUIRE_EQUAL(instance.linked(), 4u);
+    BOOST_REQUIRE_EQUAL(instance.pending(), 0u);
+
+    for (const auto& header: headers)
+        BOOST_REQUIRE(instance.contains(header.hash()));
+}
+
+BOOST_AUTO_TEST_CASE(assume_valid__add__before_assumed_header__not_trusted_by_height)
+{
+    const auto headers = make_chain(4);
+    const chain::header::list ancestors(headers.begin(), headers.end() - 1);
+    assume_valid instance(config::checkpoint{ headers[3].hash(), 3 });
+
+    // Nothing is trusted until the headers link to the assumed hash.
+    BOOST_REQUIRE_EQUAL(instance.add(ancestors), 0u);
+    BOOST_REQUIRE_EQUAL(instance.pending(), 3u);
+    BOOST_REQUIRE(!instance.contains(headers[0].hash()));
+    BOOST_REQUIRE(!instance.contains(headers[2].hash()));
+
+    BOOST_REQUIRE_EQUAL(instance.add({ headers[3] }), 4u);
+    BOOST_REQUIRE(instance.contains(headers[0].hash()));
+    BOOST_REQUIRE(instance.complete());
+}
+
+BOOST_AUTO_TEST_CASE(assume_valid__add__descending_batches__links_incrementally)
+{
+    const auto headers = make_chain(4);
+    assume_valid instance(config::checkpoint{ headers[3].hash(), 3 });
+    BOOST_REQUIRE_EQUAL(instance.add({ headers[3], headers[2] }), 2u);
+    BOOST_REQUIRE(!instance.complete());
+    BOOST_REQUIRE(!instance.contains(headers[1].hash()));
+    BOOST_REQUIRE_EQUAL(instance.add({ headers[0], headers[1] }), 2u);
+    BOOST_REQUIRE(instance.complete());
+}
+
+BOOST_AUTO_TEST_CASE(assume_valid__add__mismatch_at_assumed_height__not_trusted)
+{
+    const auto headers = make_chain(4);
+    const auto mismatch = make_header(headers[2].hash(), 7);
+    assume_valid instance(config::checkpoint{ headers[3].hash(), 3 });
+
+    // A competing block at the assumed height does not link anything.
+    BOOST_REQUIRE_EQUAL(instance.add({ headers[0], headers[1], headers[2], mismatch }), 0u);
+    BOOST_REQUIRE(!instance.contains(mismatch.hash()));
+    BOOST_REQUIRE(!instance.contains(headers[2].hash()));
+
+    // And does not disable the assumed path once it arrives.
+    BOOST_REQUIRE_EQUAL(instance.add({ headers[3] }), 4u);
+    BOOST_REQUIRE(instance.contains(headers[2].hash()));
+    BOOST_REQUIRE(!instance.contains(mismatch.hash()));
+}
+
+BOOST_AUTO_TEST_CASE(assume_valid__add__side_branch__not_trusted)
+{
+    const auto headers = make_chain(4);
+    const auto side1 = make_header(headers[1].hash(), 7);
+    const auto side2 = make_header(side1.hash(), 7);
+    assume_valid instance(config::checkpoint{ headers[3].hash(), 3 });
+    BOOST_REQUIRE_EQUAL(instance.add({ side1, side2 }), 0u);
+    BOOST_REQUIRE_EQUAL(instance.add(headers), 4u);
+    BOOST_REQUIRE(instance.contains(headers[1].hash()));
+    BOOST_REQUIRE(!instance.contains(side1.hash()));
+    BOOST_REQUIRE(!instance.contains(side2.hash()));
+
+    // Unlinked headers are released once the path reaches genesis.
+    BOOST_REQUIRE_EQUAL(instance.pending(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(assume_valid__add__assumed_header_missing__oldest_released)
+{
+    const auto headers = make_chain(10);
+    const chain::header::list first(headers.begin(), headers.begin() + 3);
+    const chain::header::list last(headers.begin() + 3, headers.end());
+
+    // The assumed hash is on no chain sent, at most four are retained.
+    assume_valid instance(config::checkpoint{ make_header(null_hash, 7).hash(), 3 });
+    BOOST_REQUIRE_EQUAL(instance.add(first), 0u);
+    BOOST_REQUIRE_EQUAL(instance.pending(), 3u);
+    BOOST_REQUIRE_EQUAL(instance.add(last), 0u);
+    BOOST_REQUIRE_EQUAL(instance.pending(), 4u);
+}
+
+BOOST_AUTO_TEST_CASE(assume_valid__add__path_evicted__links_above_gap)
+{
+    const auto headers = make_chain(4);
+    const auto side1 = make_header(headers[1].hash(), 7);
+    const auto side2 = make_header(side1.hash(), 7);
+    assume_valid instance(config::checkpoint{ headers[3].hash(), 3 });
+
+    // The genesis header is the oldest once the side branch fills the limit.
+    BOOST_REQUIRE_EQUAL(instance.add({ headers[0], headers[1], headers[2] }), 0u);
+    BOOST_REQUIRE_EQUAL(instance.add({ side1, side2 }), 0u);
+    BOOST_REQUIRE_EQUAL(instance.pending(), 4u);
+
+    BOOST_REQUIRE_EQUAL(instance.add({ headers[3] }), 3u);
+    BOOST_REQUIRE(instance.contains(headers[1].hash()));
+    BOOST_REQUIRE(!instance.contains(headers[0].hash()));
+    BOOST_REQUIRE(!instance.complete());
+}
+
+BOOST_AUTO_TEST_CASE(assume_valid__contains__descendant__false)
+{
+    const auto headers = make_chain(5);
+    assume_valid instance(config::checkpoint{ headers[3].hash(), 3 });
+    BOOST_REQUIRE_EQUAL(instance.add(headers), 4u);
+    BOOST_REQUIRE(!instance.contains(headers[4].hash()));
+}
+
+BOOST_AUTO_TEST_CASE(assume_valid__add__complete__ignored)
+{
+    const auto headers = make_chain(4);
+    assume_valid instance(config::checkpoint{ headers[3].hash(), 3 });
+    BOOST_REQUIRE_EQUAL(instance.add(headers), 4u);
+    BOOST_REQUIRE_EQUAL(instance.add({ make_header(headers[3].hash(), 1) }), 0u);
+    BOOST_REQUIRE_EQUAL(instance.pending(), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,234 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(block_cache_tests)
+
+static block_const_ptr make_cached_block(uint32_t id)
+{
+    return std::make_shared<const message::block>(message::block
+    {
+        chain::header{ id, null_hash, null_hash, 0, 0, 0 }, {}
+    });
+}
+
+// The bytes charged for a cached block before its wire form is requested.
+static size_t block_size()
+{
+    return block_cache::footprint(*make_cached_block(0));
+}
+
+static size_t wire_size()
+{
+    return make_cached_block(0)->serialized_size(
+        message::version::level::canonical);
+}
+
+// construct
+
+BOOST_AUTO_TEST_CASE(block_cache__construct__zero__disabled)
+{
+    block_cache instance(0);
+    BOOST_REQUIRE(!instance.enabled());
+    instance.add(make_cached_block(1), 1);
+    BOOST_REQUIRE_EQUAL(instance.count(), 0u);
+    BOOST_REQUIRE(!instance.get(1));
+}
+
+BOOST_AUTO_TEST_CASE(block_cache__construct__nonzero__enabled_empty)
+{
+    block_cache instance(42);
+    BOOST_REQUIRE(instance.enabled());
+    BOOST_REQUIRE_EQUAL(instance.capacity(), 42u);
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.count(), 0u);
+}
+
+// add/get
+
+BOOST_AUTO_TEST_CASE(block_cache__get__by_height__round_trips)
+{
+    block_cache instance(10 * block_size());
+    const auto block = make_cached_block(1);
+    instance.add(block, 42);
+    BOOST_REQUIRE(instance.get(42) == block);
+    BOOST_REQUIRE(!instance.get(41));
+    BOOST_REQUIRE_EQUAL(instance.hits(), 1u);
+    BOOST_REQUIRE_EQUAL(instance.misses(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(block_cache__get__by_hash__round_trips_height)
+{
+    block_cache instance(10 * block_size());
+    const auto block = make_cached_block(1);
+    instance.add(block, 42);
+
+    size_t height = 0;
+    BOOST_REQUIRE(instance.get(block->hash(), height) == block);
+    BOOST_REQUIRE_EQUAL(height, 42u);
+    BOOST_REQUIRE(!instance.get(null_hash, height));
+}
+
+BOOST_AUTO_TEST_CASE(block_cache__add__same_height__replaces)
+{
+    block_cache instance(10 * block_size());
+    const auto block1 = make_cached_block(1);
+    const auto block2 = make_cached_block(2);
+    instance.add(block1, 42);
+    instance.add(block2, 42);
+
+    size_t height;
+    BOOST_REQUIRE_EQUAL(instance.count(), 1u);
+    BOOST_REQUIRE_EQUAL(instance.size(), block_size());
+    BOOST_REQUIRE(instance.get(42) == block2);
+    BOOST_REQUIRE(!instance.get(block1->hash(), height));
+}
+
+// get_data
+
+BOOST_AUTO_TEST_CASE(block_cache__get_data__cached__serialized_once)
+{
+    block_cache instance(10 * block_size());
+    const auto block = make_cached_block(1);
+    instance.add(block, 42);
+
+    size_t height;
+    const auto data1 = instance.get_data(42);
+    const auto data2 = instance.get_data(block->hash(), height);
+    BOOST_REQUIRE(data1);
+    BOOST_REQUIRE(data1 == data2);
+    BOOST_REQUIRE(*data1 == block->to_data(message::version::level::canonical));
+}
+
+BOOST_AUTO_TEST_CASE(block_cache__get_data__over_capacity__counted_evicts_least_recently_used)
+{
+    block_cache instance(2 * block_size());
+    instance.add(make_cached_block(1), 1);
+    instance.add(make_cached_block(2), 2);
+    BOOST_REQUIRE_EQUAL(instance.size(), 2 * block_size());
+
+    // The wire form is counted, it displaces the older block.
+    BOOST_REQUIRE(instance.get_data(2));
+    BOOST_REQUIRE_EQUAL(instance.count(), 1u);
+    BOOST_REQUIRE_EQUAL(instance.size(), block_size() + wire_size());
+    BOOST_REQUIRE(!instance.peek(1));
+    BOOST_REQUIRE(instance.peek(2));
+}
+
+BOOST_AUTO_TEST_CASE(block_cache__get_data__missing__nullptr)
+{
+    block_cache instance(10 * block_size());
+    BOOST_REQUIRE(!instance.get_data(42));
+}
+
+// remove_above
+
+BOOST_AUTO_TEST_CASE(block_cache__remove_above__removes_higher_only)
+{
+    block_cache instance(10 * block_size());
+    instance.add(make_cached_block(1), 1);
+    instance.add(make_cached_block(2), 2);
+    instance.add(make_cached_block(3), 3);
+    instance.remove_above(1);
+
+    BOOST_REQUIRE_EQUAL(instance.count(), 1u);
+    BOOST_REQUIRE_EQUAL(instance.size(), block_size());
+    BOOST_REQUIRE(instance.get(1));
+    BOOST_REQUIRE(!instance.get(2));
+    BOOST_REQUIRE(!instance.get(3));
+}
+
+// generation
+
+BOOST_AUTO_TEST_CASE(block_cache__add__same_generation__added)
+{
+    block_cache instance(10 * block_size());
+    const auto generation = instance.generation();
+    const auto block = make_cached_block(1);
+    instance.add(block, 1, generation);
+    BOOST_REQUIRE(instance.get(1) == block);
+}
+
+BOOST_AUTO_TEST_CASE(block_cache__add__reorganized_since_generation__not_added)
+{
+    block_cache instance(10 * block_size());
+
+    // A reader takes the generation and reads the store, which is then
+    // reorganized below the height being read.
+    const auto generation = instance.generation();
+    instance.remove_above(0);
+    BOOST_REQUIRE(instance.generation() != generation);
+
+    instance.add(make_cached_block(1), 1, generation);
+    BOOST_REQUIRE_EQUAL(instance.count(), 0u);
+    BOOST_REQUIRE(!instance.get(1));
+}
+
+// peek
+
+BOOST_AUTO_TEST_CASE(block_cache__peek__cached__not_counted_or_touched)
+{
+    block_cache instance(2 * block_size());
+    const auto block1 = make_cached_block(1);
+    instance.add(block1, 1);
+    instance.add(make_cached_block(2), 2);
+
+    // Peeking the oldest block leaves it the least recently used.
+    BOOST_REQUIRE(instance.peek(1) == block1);
+    BOOST_REQUIRE(!instance.peek(3));
+    BOOST_REQUIRE_EQUAL(instance.hits(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.misses(), 0u);
+
+    instance.add(make_cached_block(3), 3);
+    BOOST_REQUIRE(!instance.peek(1));
+    BOOST_REQUIRE(instance.peek(2));
+}
+
+// capacity
+
+BOOST_AUTO_TEST_CASE(block_cache__add__over_capacity__evicts_least_recently_used)
+{
+    block_cache instance(2 * block_size());
+    instance.add(make_cached_block(1), 1);
+    instance.add(make_cached_block(2), 2);
+
+    // Touch the first block so that the second is the oldest.
+    BOOST_REQUIRE(instance.get(1));
+    instance.add(make_cached_block(3), 3);
+
+    BOOST_REQUIRE_EQUAL(instance.count(), 2u);
+    BOOST_REQUIRE(instance.get(1));
+    BOOST_REQUIRE(!instance.get(2));
+    BOOST_REQUIRE(instance.get(3));
+}
+
+BOOST_AUTO_TEST_CASE(block_cache__add__larger_than_capacity__not_cached)
+{
+    block_cache instance(block_size() + wire_size() - 1);
+    instance.add(make_cached_block(1), 1);
+    BOOST_REQUIRE_EQUAL(instance.count(), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -18,9 +18,12 @@
  */
 #include <boost/test/unit_test.hpp>
 
+#include <atomic>
 #include <future>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <vector>
 #include <bitcoin/blockchain.hpp>
 
 using namespace bc;
@@ -452,6 +455,42 @@ BOOST_AUTO_TEST_CASE(block_chain__get_is_unspent_transaction__spent_below_fork__
 }
 #endif // BITPRIM_DB_LEGACY
 
+// is_assumed_valid
+
+BOOST_AUTO_TEST_CASE(block_chain__is_assumed_valid__headers_added__ancestors_only)
+{
+    threadpool pool;
+    database::settings database_settings;
+    database_settings.flush_writes = false;
+    database_settings.directory = TEST_NAME;
+    BOOST_REQUIRE(create_database(database_settings));
+
+    const auto block1 = NEW_BLOCK(1);
+    const auto block2 = NEW_BLOCK(2);
+    const auto block3 = NEW_BLOCK(3);
+    blockchain::settings blockchain_settings;
+    blockchain_settings.assume_valid = config::checkpoint{ block2->hash(), 2 };
+    block_chain instance(pool, blockchain_settings, database_settings);
+    BOOST_REQUIRE(instance.start());
+
+    // Nothing is assumed valid until the node feeds the headers.
+    BOOST_REQUIRE(!instance.is_assumed_valid(block1->hash()));
+    BOOST_REQUIRE(!instance.is_assumed_valid(block2->hash()));
+
+    const chain::header::list headers
+    {
+        chain::block::genesis_mainnet().header(),
+        block1->header(),
+        block2->header(),
+        block3->header()
+    };
+
+    BOOST_REQUIRE_EQUAL(instance.add_assume_valid_headers(headers), 3u);
+    BOOST_REQUIRE(instance.is_assumed_valid(block1->hash()));
+    BOOST_REQUIRE(instance.is_assumed_valid(block2->hash()));
+    BOOST_REQUIRE(!instance.is_assumed_valid(block3->hash()));
+}
+
 ////BOOST_AUTO_TEST_CASE(block_chain__get_transaction__exists__true)
 ////{
 ////    START_BLOCKCHAIN(instance, false);
@@ -814,6 +853,260 @@ BOOST_AUTO_TEST_CASE(block_chain__fetch_locator_block_headers__limited__sequenti
     const auto locator = std::make_shared<const message::get_headers>();
     BOOST_REQUIRE_EQUAL(fetch_locator_block_headers(instance, locator, null_hash, 2), error::success);
 }
+
+// scan_transactions
+
+BOOST_AUTO_TEST_CASE(block_chain__scan_transactions__ordered__chain_order)
+{
+    START_BLOCKCHAIN(instance, false);
+
+    const auto block1 = NEW_BLOCK(1);
+    const auto block2 = NEW_BLOCK(2);
+    const auto block3 = NEW_BLOCK(3);
+    BOOST_REQUIRE(instance.insert(block1, 1));
+    BOOST_REQUIRE(instance.insert(block2, 2));
+    BOOST_REQUIRE(instance.insert(block3, 3));
+
+    safe_chain::scan_options options;
+    options.threads = 3;
+    options.prefetch = 1;
+    std::vector<size_t> heights;
+    hash_list hashes;
+
+    const auto ec = instance.scan_transactions(1, 3, options,
+        [&](size_t height, size_t position, transaction_const_ptr tx)
+        {
+            BOOST_REQUIRE_EQUAL(position, 0u);
+            heights.push_back(height);
+            hashes.push_back(tx->hash());
+            return true;
+        });
+
+    BOOST_REQUIRE_EQUAL(ec, error::success);
+    BOOST_REQUIRE_EQUAL(heights.size(), 3u);
+    BOOST_REQUIRE_EQUAL(heights[0], 1u);
+    BOOST_REQUIRE_EQUAL(heights[2], 3u);
+    BOOST_REQUIRE(hashes[1] == block2->transactions()[0].hash());
+}
+
+BOOST_AUTO_TEST_CASE(block_chain__scan_transactions__unordered_copies__all_delivered)
+{
+    START_BLOCKCHAIN(instance, false);
+
+    BOOST_REQUIRE(instance.insert(NEW_BLOCK(1), 1));
+    BOOST_REQUIRE(instance.insert(NEW_BLOCK(2), 2));
+    BOOST_REQUIRE(instance.insert(NEW_BLOCK(3), 3));
+
+    safe_chain::scan_options options;
+    options.ordered = false;
+    options.borrowed = false;
+    std::atomic<size_t> count(0);
+
+    const auto ec = instance.scan_transactions(0, 3, options,
+        [&](size_t, size_t, transaction_const_ptr)
+        {
+            ++count;
+            return true;
+        });
+
+    BOOST_REQUIRE_EQUAL(ec, error::success);
+    BOOST_REQUIRE_EQUAL(count, 4u);
+}
+
+BOOST_AUTO_TEST_CASE(block_chain__scan_transactions__cancelled__stops)
+{
+    START_BLOCKCHAIN(instance, false);
+
+    BOOST_REQUIRE(instance.insert(NEW_BLOCK(1), 1));
+    BOOST_REQUIRE(instance.insert(NEW_BLOCK(2), 2));
+    BOOST_REQUIRE(instance.insert(NEW_BLOCK(3), 3));
+
+    safe_chain::scan_options options;
+    size_t count = 0;
+
+    const auto ec = instance.scan_transactions(0, 3, options,
+        [&](size_t, size_t, transaction_const_ptr)
+        {
+            return ++count < 2;
+        });
+
+    BOOST_REQUIRE_EQUAL(ec, error::success);
+    BOOST_REQUIRE_EQUAL(count, 2u);
+}
+
+BOOST_AUTO_TEST_CASE(block_chain__scan_transactions__missing_block__lower_heights_delivered_then_not_found)
+{
+    START_BLOCKCHAIN(instance, false);
+
+    BOOST_REQUIRE(instance.insert(NEW_BLOCK(1), 1));
+    BOOST_REQUIRE(instance.insert(NEW_BLOCK(2), 2));
+
+    // Height 3 fails first (no transactions to read), concurrently with the
+    // reads of the lower heights, which must still be delivered.
+    safe_chain::scan_options options;
+    options.threads = 4;
+    options.prefetch = 4;
+    std::vector<size_t> heights;
+
+    const auto ec = instance.scan_transactions(0, 3, options,
+        [&](size_t height, size_t, transaction_const_ptr)
+        {
+            heights.push_back(height);
+            return true;
+        });
+
+    BOOST_REQUIRE_EQUAL(ec, error::not_found);
+    BOOST_REQUIRE_EQUAL(heights.size(), 3u);
+    BOOST_REQUIRE_EQUAL(heights[0], 0u);
+    BOOST_REQUIRE_EQUAL(heights[1], 1u);
+    BOOST_REQUIRE_EQUAL(heights[2], 2u);
+}
+
+BOOST_AUTO_TEST_CASE(block_chain__scan_transactions__handler_throws__rethrown)
+{
+    START_BLOCKCHAIN(instance, false);
+
+    BOOST_REQUIRE(instance.insert(NEW_BLOCK(1), 1));
+    BOOST_REQUIRE(instance.insert(NEW_BLOCK(2), 2));
+
+    safe_chain::scan_options options;
+    options.threads = 2;
+
+    BOOST_REQUIRE_THROW(instance.scan_transactions(0, 2, options,
+        [](size_t height, size_t, transaction_const_ptr) -> bool
+        {
+            if (height == 1)
+                throw std::runtime_error("handler");
+
+            return true;
+        }), std::runtime_error);
+}
+
+// fetch_block_headers
+
+BOOST_AUTO_TEST_CASE(block_chain__fetch_block_headers__past_top__clamped_to_top)
+{
+    START_BLOCKCHAIN(instance, false);
+
+    const auto block1 = NEW_BLOCK(1);
+    const auto block2 = NEW_BLOCK(2);
+    BOOST_REQUIRE(instance.insert(block1, 1));
+    BOOST_REQUIRE(instance.insert(block2, 2));
+
+    std::promise<chain::header::list> promise;
+    instance.fetch_block_headers(1, 3, [&](const code& ec, const chain::header::list& headers)
+    {
+        BOOST_REQUIRE_EQUAL(ec, error::success);
+        promise.set_value(headers);
+    });
+
+    const auto headers = promise.get_future().get();
+    BOOST_REQUIRE_EQUAL(headers.size(), 2u);
+    BOOST_REQUIRE(headers[0] == block1->header());
+    BOOST_REQUIRE(headers[1] == block2->header());
+}
+
+BOOST_AUTO_TEST_CASE(block_chain__fetch_block_headers__above_top__empty)
+{
+    START_BLOCKCHAIN(instance, false);
+
+    std::promise<chain::header::list> promise;
+    instance.fetch_block_headers(1, max_size_t, [&](const code& ec, const chain::header::list& headers)
+    {
+        BOOST_REQUIRE_EQUAL(ec, error::success);
+        promise.set_value(headers);
+    });
+
+    BOOST_REQUIRE(promise.get_future().get().empty());
+}
+
+// fetch_transactions
+
+BOOST_AUTO_TEST_CASE(block_chain__fetch_transactions__mixed__request_order_null_missing)
+{
+    START_BLOCKCHAIN(instance, false);
+
+    const auto block1 = NEW_BLOCK(1);
+    const auto block2 = NEW_BLOCK(2);
+    BOOST_REQUIRE(instance.insert(block1, 1));
+    BOOST_REQUIRE(instance.insert(block2, 2));
+
+    const hash_list hashes
+    {
+        block2->transactions()[0].hash(),
+        null_hash,
+        block1->transactions()[0].hash()
+    };
+
+    std::promise<std::vector<safe_chain::transaction_lookup>> promise;
+    instance.fetch_transactions(hashes, true, false,
+        [&](const code& ec, const std::vector<safe_chain::transaction_lookup>& transactions)
+        {
+            BOOST_REQUIRE_EQUAL(ec, error::success);
+            promise.set_value(transactions);
+        });
+
+    const auto transactions = promise.get_future().get();
+    BOOST_REQUIRE_EQUAL(transactions.size(), 3u);
+    BOOST_REQUIRE(transactions[0].transaction);
+    BOOST_REQUIRE(transactions[0].transaction->hash() == hashes[0]);
+    BOOST_REQUIRE_EQUAL(transactions[0].height, 2u);
+    BOOST_REQUIRE(!transactions[1].transaction);
+    BOOST_REQUIRE_EQUAL(transactions[2].height, 1u);
+}
+
+// validate_proposal
+
+static code validate_proposal_result(block_chain& instance,
+    block_const_ptr block, safe_chain::proposal_validation& out_result)
+{
+    std::promise<code> promise;
+    instance.validate_proposal(block, [&](const code& ec, const safe_chain::proposal_validation& result)
+    {
+        out_result = result;
+        promise.set_value(ec);
+    });
+
+    return promise.get_future().get();
+}
+
+BOOST_AUTO_TEST_CASE(block_chain__validate_proposal__on_top__success_not_stored)
+{
+    START_BLOCKCHAIN(instance, false);
+
+    safe_chain::proposal_validation result;
+    const auto block1 = NEW_BLOCK(1);
+    BOOST_REQUIRE_EQUAL(validate_proposal_result(instance, block1, result), error::success);
+    BOOST_REQUIRE(result.stage == safe_chain::proposal_validation::stages::connect);
+    BOOST_REQUIRE_EQUAL(result.height, 1u);
+    BOOST_REQUIRE(!result.chain_changed);
+
+    size_t height;
+    BOOST_REQUIRE(instance.get_last_height(height));
+    BOOST_REQUIRE_EQUAL(height, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(block_chain__validate_proposal__unknown_parent__orphan_block)
+{
+    START_BLOCKCHAIN(instance, false);
+
+    safe_chain::proposal_validation result;
+    BOOST_REQUIRE_EQUAL(validate_proposal_result(instance, NEW_BLOCK(2), result), error::orphan_block);
+    BOOST_REQUIRE(result.stage == safe_chain::proposal_validation::stages::accept);
+    BOOST_REQUIRE(result.connect == std::chrono::microseconds::zero());
+}
+
+BOOST_AUTO_TEST_CASE(block_chain__validate_proposal__below_top__insufficient_work)
+{
+    START_BLOCKCHAIN(instance, false);
+
+    const auto block1 = NEW_BLOCK(1);
+    BOOST_REQUIRE(instance.insert(block1, 1));
+
+    safe_chain::proposal_validation result;
+    BOOST_REQUIRE_EQUAL(validate_proposal_result(instance, NEW_BLOCK(1), result), error::insufficient_work);
+    BOOST_REQUIRE(result.stage == safe_chain::proposal_validation::stages::accept);
+}
 #endif // BITPRIM_DB_LEGACY
 
 // TODO: fetch_template
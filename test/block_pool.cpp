@@ -18,6 +18,7 @@
  */
 #include <boost/test/unit_test.hpp>
 
+#include <memory>
 #include <utility>
 #include <bitcoin/blockchain.hpp>
 
@@ -48,7 +49,9 @@ public:
 
     block_const_ptr parent(block_const_ptr block) const
     {
-        return block_pool::parent(block);
+        block_outpoints::const_ptr outpoints;
+        uint256_t proof;
+        return block_pool::parent(block, outpoints, proof);
     }
 
     size_t maximum_depth() const
@@ -573,6 +576,30 @@ BOOST_AUTO_TEST_CASE(block_pool__get_path__connected_one_path__expected_path)
     BOOST_REQUIRE((*path->blocks())[4] == block5);
 }
 
+BOOST_AUTO_TEST_CASE(block_pool__get_path__connected__shares_pooled_outpoints)
+{
+    block_pool_fixture instance(0);
+    const auto block1 = make_block(1, 42);
+    const auto block2 = make_block(2, 43, block1);
+    const auto block3 = make_block(3, 44, block2);
+    const auto outpoints1 = std::make_shared<const block_outpoints>(block1);
+
+    instance.add(block1, outpoints1);
+    instance.add(block2);
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+
+    const auto path = instance.get_path(block3);
+    BOOST_REQUIRE_EQUAL(path->outpoints().size(), 3u);
+    BOOST_REQUIRE(path->outpoints()[0] == outpoints1);
+    BOOST_REQUIRE(path->outpoints()[1]->block() == block2);
+    BOOST_REQUIRE(path->top_outpoints()->block() == block3);
+
+    // Pooled blocks are indexed once and shared by reference.
+    const auto other = instance.get_path(make_block(4, 44, block2));
+    BOOST_REQUIRE(other->outpoints()[0] == outpoints1);
+    BOOST_REQUIRE(other->outpoints()[1] == path->outpoints()[1]);
+}
+
 BOOST_AUTO_TEST_CASE(block_pool__get_path__connected_multiple_paths__expected_path)
 {
     block_pool_fixture instance(0);
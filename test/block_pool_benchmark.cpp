@@ -0,0 +1,156 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+// Built into bitprim_blockchain_benchmark, not registered with ctest:
+// bitprim_blockchain_benchmark --run_test=block_pool_benchmarks --log_level=message
+BOOST_AUTO_TEST_SUITE(block_pool_benchmarks)
+
+// Competing blocks as left by withholding spam: many short branches off a
+// few hundred chain heights.
+static const size_t benchmark_roots = 500;
+static const size_t benchmark_branch_length = 8;
+static const size_t benchmark_blocks = benchmark_roots * benchmark_branch_length;
+static const size_t benchmark_inventories = 500;
+
+typedef std::chrono::high_resolution_clock benchmark_clock;
+
+static double seconds_since(const benchmark_clock::time_point& start)
+{
+    return std::chrono::duration<double>(benchmark_clock::now() - start).count();
+}
+
+static block_const_ptr make_pool_block(uint32_t id, size_t height,
+    const hash_digest& parent)
+{
+    const auto block = std::make_shared<const message::block>(message::block
+    {
+        chain::header{ id, parent, null_hash, 0, 0, 0 }, {}
+    });
+
+    block->header().validation.height = height;
+    return block;
+}
+
+static block_const_ptr_list make_branches()
+{
+    block_const_ptr_list blocks;
+    blocks.reserve(benchmark_blocks);
+    uint32_t id = 0;
+
+    for (size_t root = 0; root < benchmark_roots; ++root)
+    {
+        // Each branch forks from a distinct (unpooled) chain block.
+        auto parent = bitcoin_hash(to_chunk(to_little_endian(uint32_t(root))));
+
+        for (size_t depth = 0; depth < benchmark_branch_length; ++depth)
+        {
+            const auto block = make_pool_block(++id, root + depth + 1, parent);
+            blocks.push_back(block);
+            parent = block->hash();
+        }
+    }
+
+    return blocks;
+}
+
+static get_data_ptr make_message(const block_const_ptr_list& blocks)
+{
+    const auto request = std::make_shared<message::get_data>();
+    auto& inventories = request->inventories();
+
+    // Half pooled, half unknown hashes.
+    for (size_t index = 0; index < benchmark_inventories; ++index)
+    {
+        const auto hash = index % 2 == 0 ?
+            blocks[(index * 7919) % blocks.size()]->hash() :
+            bitcoin_hash(to_chunk(to_little_endian(uint32_t(index))));
+
+        inventories.emplace_back(message::inventory_vector::type_id::block, hash);
+    }
+
+    return request;
+}
+
+BOOST_AUTO_TEST_CASE(block_pool__competing_blocks__operations_timing)
+{
+    const auto blocks = make_branches();
+    block_pool instance(benchmark_roots);
+
+    auto start = benchmark_clock::now();
+
+    for (const auto& block: blocks)
+        instance.add(block);
+
+    const auto add_seconds = seconds_since(start);
+    BOOST_REQUIRE_EQUAL(instance.size(), benchmark_blocks);
+
+    start = benchmark_clock::now();
+
+    for (size_t index = 0; index < 100; ++index)
+        instance.filter(make_message(blocks));
+
+    const auto filter_seconds = seconds_since(start);
+
+    // Extend the last block of each branch, the path spans the branch.
+    start = benchmark_clock::now();
+
+    for (size_t root = 0; root < benchmark_roots; ++root)
+    {
+        const auto tip = blocks[(root + 1) * benchmark_branch_length - 1];
+        const auto candidate = make_pool_block(0, 0, tip->hash());
+        BOOST_REQUIRE_EQUAL(instance.get_path(candidate)->size(),
+            benchmark_branch_length + 1);
+    }
+
+    const auto path_seconds = seconds_since(start);
+
+    // Accept the first branch, its blocks leave the pool.
+    const auto accepted = std::make_shared<block_const_ptr_list>(
+        blocks.begin(), blocks.begin() + benchmark_branch_length);
+
+    start = benchmark_clock::now();
+    instance.remove(accepted);
+    const auto remove_seconds = seconds_since(start);
+
+    // Expire the lower half of the roots.
+    start = benchmark_clock::now();
+    instance.prune(benchmark_roots + benchmark_roots / 2);
+    const auto prune_seconds = seconds_since(start);
+
+    BOOST_REQUIRE_LT(instance.size(), benchmark_blocks);
+
+    BOOST_TEST_MESSAGE("block_pool: " << benchmark_blocks << " blocks, "
+        << "add " << add_seconds * 1000 << " ms, "
+        << "filter (100 x " << benchmark_inventories << ") " << filter_seconds * 1000 << " ms, "
+        << "get_path (" << benchmark_roots << ") " << path_seconds * 1000 << " ms, "
+        << "remove " << remove_seconds * 1000 << " ms, "
+        << "prune " << prune_seconds * 1000 << " ms");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
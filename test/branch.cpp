@@ -307,4 +307,100 @@ BOOST_AUTO_TEST_CASE(branch__work__two_blocks__expected)
     BOOST_REQUIRE(instance.work() == 0);
 }
 
+BOOST_AUTO_TEST_CASE(branch__work__pushed_proofs__accumulated)
+{
+    branch instance;
+    DECLARE_BLOCK(block, 0);
+    DECLARE_BLOCK(block, 1);
+
+    // Link the blocks.
+    block1->header().set_previous_block_hash(block0->hash());
+
+    const auto outpoints0 = std::make_shared<const block_outpoints>(block0);
+    const auto outpoints1 = std::make_shared<const block_outpoints>(block1);
+    BOOST_REQUIRE(instance.push_front(block1, outpoints1, 42));
+    BOOST_REQUIRE(instance.push_front(block0, outpoints0, 7));
+    BOOST_REQUIRE(instance.work() == 49);
+}
+
+// populate_spent
+
+static chain::transaction::list spending_transactions(const chain::output_point& spent)
+{
+    static const chain::output_point null_point{ null_hash, chain::point::null_index };
+    const chain::transaction coinbase{ 1, 0, { { null_point, {}, 0 } }, { { 50, {} } } };
+    const chain::transaction spender{ 1, 0, { { spent, {}, 0 } }, { { 42, {} } } };
+    return { coinbase, spender };
+}
+
+BOOST_AUTO_TEST_CASE(branch__populate_spent__spent_below_top__true)
+{
+    DECLARE_BLOCK(block, 0);
+    DECLARE_BLOCK(block, 1);
+    const chain::output_point outpoint{ hash_literal(
+        "4a5e1e4baab89f3a32518a88c31bc87f618f76673e2cc77ab2127b7afdeda33b"), 0 };
+    block0->set_transactions(spending_transactions(outpoint));
+    block1->set_transactions(spending_transactions({ null_hash, 1 }));
+
+    // Link the blocks.
+    block1->header().set_previous_block_hash(block0->hash());
+
+    branch instance;
+    BOOST_REQUIRE(instance.push_front(block1));
+    BOOST_REQUIRE(instance.push_front(block0));
+    BOOST_REQUIRE_EQUAL(instance.outpoints().size(), 2u);
+
+    instance.populate_spent(outpoint);
+    BOOST_REQUIRE(outpoint.validation.spent);
+    BOOST_REQUIRE(outpoint.validation.confirmed);
+}
+
+BOOST_AUTO_TEST_CASE(branch__populate_spent__spent_only_by_top__false)
+{
+    DECLARE_BLOCK(block, 0);
+    DECLARE_BLOCK(block, 1);
+    const chain::output_point outpoint{ hash_literal(
+        "4a5e1e4baab89f3a32518a88c31bc87f618f76673e2cc77ab2127b7afdeda33b"), 0 };
+    block0->set_transactions(spending_transactions({ null_hash, 1 }));
+    block1->set_transactions(spending_transactions(outpoint));
+
+    // Link the blocks.
+    block1->header().set_previous_block_hash(block0->hash());
+
+    branch instance;
+    BOOST_REQUIRE(instance.push_front(block1));
+    BOOST_REQUIRE(instance.push_front(block0));
+
+    instance.populate_spent(outpoint);
+    BOOST_REQUIRE(!outpoint.validation.spent);
+    BOOST_REQUIRE(!outpoint.validation.confirmed);
+}
+
+// populate_prevout
+
+BOOST_AUTO_TEST_CASE(branch__populate_prevout__created_in_branch__expected)
+{
+    DECLARE_BLOCK(block, 0);
+    DECLARE_BLOCK(block, 1);
+    block0->set_transactions(spending_transactions({ null_hash, 1 }));
+    block1->set_transactions(spending_transactions({ null_hash, 2 }));
+
+    // Link the blocks.
+    block1->header().set_previous_block_hash(block0->hash());
+
+    const auto instance = std::make_shared<branch>(41);
+    BOOST_REQUIRE(instance->push_front(block1));
+    BOOST_REQUIRE(instance->push_front(block0));
+
+    const auto branch_utxo = create_branch_utxo_set(instance);
+    BOOST_REQUIRE_EQUAL(branch_utxo.size(), 2u);
+
+    const chain::output_point outpoint{ block0->transactions()[1].hash(), 0 };
+    instance->populate_prevout(outpoint, branch_utxo);
+    BOOST_REQUIRE(outpoint.validation.cache.is_valid());
+    BOOST_REQUIRE_EQUAL(outpoint.validation.cache.value(), 42u);
+    BOOST_REQUIRE_EQUAL(outpoint.validation.height, 42u);
+    BOOST_REQUIRE(!outpoint.validation.coinbase);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,407 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <vector>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(chain_notifier_tests)
+
+typedef chain_notifier::reorganization reorganization;
+
+static block_const_ptr make_notified_block(uint32_t id)
+{
+    return std::make_shared<const message::block>(message::block
+    {
+        chain::header{ id, null_hash, null_hash, 0, 0, 0 }, {}
+    });
+}
+
+static block_const_ptr_list_const_ptr make_list(
+    const block_const_ptr_list& blocks)
+{
+    return std::make_shared<const block_const_ptr_list>(blocks);
+}
+
+static reorganization make_reorganization(size_t fork_height,
+    const block_const_ptr_list& incoming,
+    const block_const_ptr_list& outgoing)
+{
+    return { error::success, fork_height, make_list(incoming),
+        make_list(outgoing) };
+}
+
+// coalesce
+
+BOOST_AUTO_TEST_CASE(chain_notifier__coalesce__consecutive_connections__appended)
+{
+    const auto block1 = make_notified_block(1);
+    const auto block2 = make_notified_block(2);
+    auto pending = make_reorganization(10, { block1 }, {});
+    const auto next = make_reorganization(11, { block2 }, {});
+    BOOST_REQUIRE(chain_notifier::coalesce(pending, next));
+    BOOST_REQUIRE_EQUAL(pending.fork_height, 10u);
+    BOOST_REQUIRE_EQUAL(pending.incoming->size(), 2u);
+    BOOST_REQUIRE((*pending.incoming)[0] == block1);
+    BOOST_REQUIRE((*pending.incoming)[1] == block2);
+    BOOST_REQUIRE(pending.outgoing->empty());
+}
+
+BOOST_AUTO_TEST_CASE(chain_notifier__coalesce__next_pops_pending__replaced)
+{
+    const auto block1 = make_notified_block(1);
+    const auto block2 = make_notified_block(2);
+    const auto block3 = make_notified_block(3);
+    auto pending = make_reorganization(10, { block1, block2 }, {});
+    const auto next = make_reorganization(11, { block3 }, { block2 });
+    BOOST_REQUIRE(chain_notifier::coalesce(pending, next));
+    BOOST_REQUIRE_EQUAL(pending.fork_height, 10u);
+    BOOST_REQUIRE_EQUAL(pending.incoming->size(), 2u);
+    BOOST_REQUIRE((*pending.incoming)[0] == block1);
+    BOOST_REQUIRE((*pending.incoming)[1] == block3);
+}
+
+BOOST_AUTO_TEST_CASE(chain_notifier__coalesce__next_below_pending__outgoing_joined)
+{
+    const auto chain11 = make_notified_block(11);
+    const auto chain12 = make_notified_block(12);
+    const auto block1 = make_notified_block(1);
+    const auto block2 = make_notified_block(2);
+    auto pending = make_reorganization(11, { block1 }, { chain12 });
+    const auto next = make_reorganization(10, { block2 }, { chain11, block1 });
+    BOOST_REQUIRE(chain_notifier::coalesce(pending, next));
+    BOOST_REQUIRE_EQUAL(pending.fork_height, 10u);
+    BOOST_REQUIRE_EQUAL(pending.incoming->size(), 1u);
+    BOOST_REQUIRE((*pending.incoming)[0] == block2);
+    BOOST_REQUIRE_EQUAL(pending.outgoing->size(), 2u);
+    BOOST_REQUIRE((*pending.outgoing)[0] == chain11);
+    BOOST_REQUIRE((*pending.outgoing)[1] == chain12);
+}
+
+BOOST_AUTO_TEST_CASE(chain_notifier__coalesce__gap__false)
+{
+    auto pending = make_reorganization(10, { make_notified_block(1) }, {});
+    const auto next = make_reorganization(12, { make_notified_block(2) }, {});
+    BOOST_REQUIRE(!chain_notifier::coalesce(pending, next));
+    BOOST_REQUIRE_EQUAL(pending.incoming->size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(chain_notifier__coalesce__outgoing_mismatch__false)
+{
+    auto pending = make_reorganization(10, { make_notified_block(1) }, {});
+    const auto next = make_reorganization(10, { make_notified_block(2) },
+        { make_notified_block(3) });
+    BOOST_REQUIRE(!chain_notifier::coalesce(pending, next));
+}
+
+BOOST_AUTO_TEST_CASE(chain_notifier__coalesce__stop_event__false)
+{
+    auto pending = make_reorganization(10, { make_notified_block(1) }, {});
+    const reorganization next{ error::service_stopped, 0, {}, {} };
+    BOOST_REQUIRE(!chain_notifier::coalesce(pending, next));
+}
+
+// subscribe/notify
+
+BOOST_AUTO_TEST_CASE(chain_notifier__subscribe_blockchain__stopped__service_stopped)
+{
+    threadpool pool(1);
+    chain_notifier instance(pool, 4, std::chrono::milliseconds(0));
+
+    code result;
+    instance.subscribe_blockchain([&result](code ec, size_t,
+        block_const_ptr_list_const_ptr, block_const_ptr_list_const_ptr)
+    {
+        result = ec;
+        return false;
+    });
+
+    BOOST_REQUIRE_EQUAL(result, error::service_stopped);
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_CASE(chain_notifier__notify__held_subscriber__coalesced)
+{
+    threadpool pool(2);
+    chain_notifier instance(pool, 4, std::chrono::milliseconds(0));
+    BOOST_REQUIRE(instance.start());
+
+    std::promise<void> released;
+    auto release = released.get_future().share();
+    std::promise<void> entered;
+    std::promise<reorganization> second;
+    size_t calls = 0;
+
+    instance.subscribe_blockchain([&](code ec, size_t fork_height,
+        block_const_ptr_list_const_ptr incoming,
+        block_const_ptr_list_const_ptr outgoing)
+    {
+        if (ec)
+            return false;
+
+        // The first delivery holds the subscriber while others queue.
+        if (++calls == 1)
+        {
+            entered.set_value();
+            release.wait();
+            return true;
+        }
+
+        second.set_value({ ec, fork_height, incoming, outgoing });
+        return true;
+    });
+
+    const auto block1 = make_notified_block(1);
+    const auto block2 = make_notified_block(2);
+    const auto block3 = make_notified_block(3);
+    instance.notify(0, make_list({ block1 }), make_list({}));
+    entered.get_future().wait();
+    instance.notify(1, make_list({ block2 }), make_list({}));
+    instance.notify(2, make_list({ block3 }), make_list({}));
+    released.set_value();
+
+    const auto result = second.get_future().get();
+    BOOST_REQUIRE_EQUAL(result.fork_height, 1u);
+    BOOST_REQUIRE_EQUAL(result.incoming->size(), 2u);
+    BOOST_REQUIRE((*result.incoming)[0] == block2);
+    BOOST_REQUIRE((*result.incoming)[1] == block3);
+    BOOST_REQUIRE(instance.stop());
+    BOOST_REQUIRE_EQUAL(instance.dropped_reorganizations(), 0u);
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_CASE(chain_notifier__notify__held_subscriber_far_behind__blocks_released_operation_failed)
+{
+    threadpool pool(2);
+    chain_notifier instance(pool, 4, std::chrono::milliseconds(0));
+    BOOST_REQUIRE(instance.start());
+
+    std::promise<void> released;
+    auto release = released.get_future().share();
+    std::promise<void> entered;
+    std::promise<code> failure;
+    size_t calls = 0;
+
+    instance.subscribe_blockchain([&](code ec, size_t,
+        block_const_ptr_list_const_ptr, block_const_ptr_list_const_ptr)
+    {
+        if (ec)
+        {
+            failure.set_value(ec);
+            return false;
+        }
+
+        if (++calls == 1)
+        {
+            entered.set_value();
+            release.wait();
+        }
+
+        return true;
+    });
+
+    instance.notify(0, make_list({ make_notified_block(0) }), make_list({}));
+    entered.get_future().wait();
+
+    // Consecutive connections coalesce, the notifier holds no more blocks
+    // than the limit for a subscriber that does not return.
+    std::vector<std::weak_ptr<const message::block>> notified;
+    for (uint32_t height = 1; height <= 100; ++height)
+    {
+        const auto block = make_notified_block(height);
+        notified.push_back(block);
+        instance.notify(height, make_list({ block }), make_list({}));
+    }
+
+    const auto held = std::count_if(notified.begin(), notified.end(),
+        [](const std::weak_ptr<const message::block>& block)
+        {
+            return !block.expired();
+        });
+
+    BOOST_REQUIRE_LE(held, 4);
+    released.set_value();
+    BOOST_REQUIRE_EQUAL(failure.get_future().get(), error::operation_failed);
+    BOOST_REQUIRE_GT(instance.dropped_reorganizations(), 0u);
+    BOOST_REQUIRE(instance.stop());
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_CASE(chain_notifier__notify__transactions_in_window__delivered_in_order)
+{
+    threadpool pool(2);
+    chain_notifier instance(pool, 16, std::chrono::milliseconds(10));
+    BOOST_REQUIRE(instance.start());
+
+    std::vector<transaction_const_ptr> delivered;
+    std::promise<void> complete;
+    instance.subscribe_transaction([&](code ec, transaction_const_ptr tx)
+    {
+        if (ec)
+            return false;
+
+        delivered.push_back(tx);
+
+        if (delivered.size() == 3)
+            complete.set_value();
+
+        return true;
+    });
+
+    const auto tx1 = std::make_shared<const message::transaction>(message::transaction{ 1, 1, {}, {} });
+    const auto tx2 = std::make_shared<const message::transaction>(message::transaction{ 1, 2, {}, {} });
+    const auto tx3 = std::make_shared<const message::transaction>(message::transaction{ 1, 3, {}, {} });
+    instance.notify(tx1);
+    instance.notify(tx2);
+    instance.notify(tx3);
+
+    complete.get_future().wait();
+    BOOST_REQUIRE(delivered[0] == tx1);
+    BOOST_REQUIRE(delivered[1] == tx2);
+    BOOST_REQUIRE(delivered[2] == tx3);
+    BOOST_REQUIRE(instance.stop());
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_CASE(chain_notifier__destruct__window_pending__not_delivered)
+{
+    // One thread, so the window of the first instance expires first.
+    threadpool pool(1);
+    size_t first_delivered = 0;
+    const auto tx = std::make_shared<const message::transaction>(message::transaction{ 1, 1, {}, {} });
+
+    {
+        chain_notifier instance(pool, 16, std::chrono::milliseconds(10));
+        BOOST_REQUIRE(instance.start());
+        instance.subscribe_transaction([&](code ec, transaction_const_ptr)
+        {
+            if (!ec)
+                ++first_delivered;
+
+            return true;
+        });
+
+        instance.notify(tx);
+    }
+
+    chain_notifier second(pool, 16, std::chrono::milliseconds(10));
+    BOOST_REQUIRE(second.start());
+
+    std::promise<void> complete;
+    second.subscribe_transaction([&](code ec, transaction_const_ptr)
+    {
+        if (!ec)
+            complete.set_value();
+
+        return false;
+    });
+
+    second.notify(tx);
+    complete.get_future().wait();
+    BOOST_REQUIRE_EQUAL(first_delivered, 0u);
+    BOOST_REQUIRE(second.stop());
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_CASE(chain_notifier__notify__full_queue__oldest_dropped)
+{
+    threadpool pool(2);
+    chain_notifier instance(pool, 2, std::chrono::milliseconds(0));
+    BOOST_REQUIRE(instance.start());
+
+    std::promise<void> released;
+    auto release = released.get_future().share();
+    std::promise<void> entered;
+    std::promise<void> complete;
+    std::vector<transaction_const_ptr> delivered;
+
+    instance.subscribe_transaction([&](code ec, transaction_const_ptr tx)
+    {
+        if (ec)
+            return false;
+
+        delivered.push_back(tx);
+
+        if (delivered.size() == 1)
+        {
+            entered.set_value();
+            release.wait();
+        }
+
+        if (delivered.size() == 3)
+            complete.set_value();
+
+        return true;
+    });
+
+    std::vector<transaction_const_ptr> txs;
+    for (uint32_t locktime = 0; locktime < 5; ++locktime)
+        txs.push_back(std::make_shared<const message::transaction>(
+            message::transaction{ 1, locktime, {}, {} }));
+
+    instance.notify(txs[0]);
+    entered.get_future().wait();
+    instance.notify(txs[1]);
+    instance.notify(txs[2]);
+    instance.notify(txs[3]);
+    instance.notify(txs[4]);
+    released.set_value();
+
+    complete.get_future().wait();
+    BOOST_REQUIRE(delivered[1] == txs[3]);
+    BOOST_REQUIRE(delivered[2] == txs[4]);
+    BOOST_REQUIRE_EQUAL(instance.dropped_transactions(), 2u);
+    BOOST_REQUIRE(instance.stop());
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_CASE(chain_notifier__stop__subscribed__service_stopped)
+{
+    threadpool pool(1);
+    chain_notifier instance(pool, 4, std::chrono::milliseconds(0));
+    BOOST_REQUIRE(instance.start());
+
+    std::promise<code> result;
+    instance.subscribe_blockchain([&result](code ec, size_t,
+        block_const_ptr_list_const_ptr, block_const_ptr_list_const_ptr)
+    {
+        result.set_value(ec);
+        return false;
+    });
+
+    BOOST_REQUIRE(instance.stop());
+    BOOST_REQUIRE_EQUAL(result.get_future().get(), error::service_stopped);
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
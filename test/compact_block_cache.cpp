@@ -0,0 +1,135 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(compact_block_cache_tests)
+
+static message::block make_full_block(uint32_t id, size_t transactions)
+{
+    chain::transaction::list txs;
+
+    for (uint32_t tx = 0; tx < transactions; ++tx)
+        txs.push_back(chain::transaction{ 1, tx, {}, {} });
+
+    return message::block
+    {
+        chain::header{ id, null_hash, null_hash, 0, 0, 0 }, std::move(txs)
+    };
+}
+
+static compact_block_ptr make_compact(uint32_t id)
+{
+    return compact_block_cache::create(make_full_block(id, 1), {}, false);
+}
+
+// create
+
+BOOST_AUTO_TEST_CASE(compact_block_cache__create__no_pool__prefills_coinbase_only)
+{
+    const auto block = make_full_block(1, 3);
+    const auto compact = compact_block_cache::create(block, {}, false);
+    BOOST_REQUIRE(compact->header() == block.header());
+    BOOST_REQUIRE_EQUAL(compact->transactions().size(), 1u);
+    BOOST_REQUIRE_EQUAL(compact->transactions()[0].index(), 0u);
+    BOOST_REQUIRE_EQUAL(compact->short_ids().size(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(compact_block_cache__create__unpooled__prefilled)
+{
+    const auto block = make_full_block(1, 3);
+    const auto compact = compact_block_cache::create(block,
+        { false, true, false }, false);
+    BOOST_REQUIRE_EQUAL(compact->transactions().size(), 2u);
+    BOOST_REQUIRE_EQUAL(compact->transactions()[0].index(), 0u);
+    BOOST_REQUIRE_EQUAL(compact->transactions()[1].index(), 2u);
+    BOOST_REQUIRE_EQUAL(compact->short_ids().size(), 1u);
+}
+
+// add/get
+
+BOOST_AUTO_TEST_CASE(compact_block_cache__construct__zero__disabled)
+{
+    compact_block_cache instance(0);
+    BOOST_REQUIRE(!instance.enabled());
+    instance.add(make_compact(1), 1);
+    BOOST_REQUIRE_EQUAL(instance.count(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(compact_block_cache__get__by_height_and_hash__round_trips)
+{
+    compact_block_cache instance(4);
+    const auto compact = make_compact(1);
+    instance.add(compact, 42);
+
+    size_t height = 0;
+    BOOST_REQUIRE(instance.get(42) == compact);
+    BOOST_REQUIRE(instance.get(compact->header().hash(), height) == compact);
+    BOOST_REQUIRE_EQUAL(height, 42u);
+    BOOST_REQUIRE(!instance.get(41));
+}
+
+BOOST_AUTO_TEST_CASE(compact_block_cache__add__full__keeps_highest)
+{
+    compact_block_cache instance(2);
+    instance.add(make_compact(1), 1);
+    instance.add(make_compact(2), 2);
+    instance.add(make_compact(3), 3);
+    instance.add(make_compact(0), 0);
+
+    BOOST_REQUIRE_EQUAL(instance.count(), 2u);
+    BOOST_REQUIRE(!instance.get(0));
+    BOOST_REQUIRE(!instance.get(1));
+    BOOST_REQUIRE(instance.get(2));
+    BOOST_REQUIRE(instance.get(3));
+}
+
+BOOST_AUTO_TEST_CASE(compact_block_cache__remove_above__removes_higher_only)
+{
+    compact_block_cache instance(4);
+    const auto compact = make_compact(2);
+    instance.add(make_compact(1), 1);
+    instance.add(compact, 2);
+    instance.remove_above(1);
+
+    size_t height;
+    BOOST_REQUIRE_EQUAL(instance.count(), 1u);
+    BOOST_REQUIRE(instance.get(1));
+    BOOST_REQUIRE(!instance.get(compact->header().hash(), height));
+}
+
+BOOST_AUTO_TEST_CASE(compact_block_cache__add__reorganized_since_generation__not_added)
+{
+    compact_block_cache instance(4);
+    const auto generation = instance.generation();
+    instance.add(make_compact(1), 1, generation);
+    BOOST_REQUIRE(instance.get(1));
+
+    instance.remove_above(1);
+    instance.add(make_compact(2), 2, generation);
+    BOOST_REQUIRE_EQUAL(instance.count(), 1u);
+    BOOST_REQUIRE(!instance.get(2));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
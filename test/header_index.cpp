@@ -0,0 +1,223 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <boost/filesystem.hpp>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(header_index_tests)
+
+static chain::header make_header(uint32_t timestamp, const hash_digest& parent)
+{
+    return chain::header{ 1, parent, null_hash, timestamp, 0x1d00ffff, 0 };
+}
+
+static void push_headers(header_index& instance, size_t count)
+{
+    auto parent = null_hash;
+
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        const auto header = make_header(1000 + index * 10, parent);
+        instance.push(header);
+        parent = header.hash();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(header_index__construct__default__empty)
+{
+    header_index instance;
+    size_t top;
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+    BOOST_REQUIRE(!instance.top_height(top));
+}
+
+BOOST_AUTO_TEST_CASE(header_index__push__three__expected_queries)
+{
+    header_index instance;
+    const auto header0 = make_header(1000, null_hash);
+    const auto header1 = make_header(1010, header0.hash());
+    const auto header2 = make_header(1020, header1.hash());
+    instance.push(header0);
+    instance.push(header1);
+    instance.push(header2);
+
+    size_t top;
+    BOOST_REQUIRE(instance.top_height(top));
+    BOOST_REQUIRE_EQUAL(top, 2u);
+
+    hash_digest hash;
+    BOOST_REQUIRE(instance.get_hash(hash, 1));
+    BOOST_REQUIRE(hash == header1.hash());
+    BOOST_REQUIRE(!instance.get_hash(hash, 3));
+
+    size_t height;
+    BOOST_REQUIRE(instance.get_height(height, header2.hash()));
+    BOOST_REQUIRE_EQUAL(height, 2u);
+
+    uint32_t value;
+    BOOST_REQUIRE(instance.get_bits(value, 0));
+    BOOST_REQUIRE_EQUAL(value, 0x1d00ffffu);
+    BOOST_REQUIRE(instance.get_timestamp(value, 2));
+    BOOST_REQUIRE_EQUAL(value, 1020u);
+    BOOST_REQUIRE(instance.get_version(value, 1));
+    BOOST_REQUIRE_EQUAL(value, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(header_index__get_median_time_past__fifteen__median_of_eleven)
+{
+    header_index instance;
+    push_headers(instance, 15);
+
+    uint32_t median;
+    BOOST_REQUIRE(instance.get_median_time_past(median, 0));
+    BOOST_REQUIRE_EQUAL(median, 1000u);
+
+    // The upper median of { 1000, 1010 }.
+    BOOST_REQUIRE(instance.get_median_time_past(median, 1));
+    BOOST_REQUIRE_EQUAL(median, 1010u);
+
+    // The median of heights [4, 14].
+    BOOST_REQUIRE(instance.get_median_time_past(median, 14));
+    BOOST_REQUIRE_EQUAL(median, 1090u);
+}
+
+BOOST_AUTO_TEST_CASE(header_index__get_locator__heights__expected_hashes)
+{
+    header_index instance;
+    push_headers(instance, 5);
+
+    hash_list hashes;
+    BOOST_REQUIRE(instance.get_locator(hashes, { 4, 2, 0 }));
+    BOOST_REQUIRE_EQUAL(hashes.size(), 3u);
+
+    hash_digest expected;
+    BOOST_REQUIRE(instance.get_hash(expected, 2));
+    BOOST_REQUIRE(hashes[1] == expected);
+
+    hash_list missing;
+    BOOST_REQUIRE(!instance.get_locator(missing, { 5 }));
+}
+
+BOOST_AUTO_TEST_CASE(header_index__get_hashes__range_above_top__clamped)
+{
+    header_index instance;
+    push_headers(instance, 5);
+
+    hash_list hashes;
+    instance.get_hashes(hashes, 3, 500);
+    BOOST_REQUIRE_EQUAL(hashes.size(), 2u);
+
+    hash_digest expected;
+    BOOST_REQUIRE(instance.get_hash(expected, 4));
+    BOOST_REQUIRE(hashes.back() == expected);
+
+    hash_list empty;
+    instance.get_hashes(empty, 6, 500);
+    BOOST_REQUIRE(empty.empty());
+}
+
+BOOST_AUTO_TEST_CASE(header_index__get_work__two__cumulative)
+{
+    header_index instance;
+    push_headers(instance, 2);
+
+    const auto proof = chain::header::proof(0x1d00ffff);
+    uint256_t work;
+    BOOST_REQUIRE(instance.get_work(work, 0));
+    BOOST_REQUIRE(work == proof);
+    BOOST_REQUIRE(instance.get_work(work, 1));
+    BOOST_REQUIRE(work == proof + proof);
+}
+
+BOOST_AUTO_TEST_CASE(header_index__truncate__above_height__hashes_removed)
+{
+    header_index instance;
+    const auto header0 = make_header(1000, null_hash);
+    const auto header1 = make_header(1010, header0.hash());
+    instance.push(header0);
+    instance.push(header1);
+
+    instance.truncate(0);
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+
+    size_t height;
+    BOOST_REQUIRE(instance.get_height(height, header0.hash()));
+    BOOST_REQUIRE(!instance.get_height(height, header1.hash()));
+
+    // Truncating above the top is a no-op.
+    instance.truncate(10);
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(header_index__get_work_above__three__difference)
+{
+    header_index instance;
+    push_headers(instance, 3);
+
+    const auto proof = chain::header::proof(0x1d00ffff);
+    BOOST_REQUIRE(instance.get_work_above(0) == proof * 3);
+    BOOST_REQUIRE(instance.get_work_above(1) == proof * 2);
+    BOOST_REQUIRE(instance.get_work_above(2) == proof);
+    BOOST_REQUIRE(instance.get_work_above(3) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(header_index__load__saved__round_trip)
+{
+    const boost::filesystem::path file = "header_index__load__saved__round_trip";
+    header_index instance;
+    push_headers(instance, 12);
+    BOOST_REQUIRE(instance.save(file));
+
+    header_index loaded;
+    BOOST_REQUIRE(loaded.load(file));
+    BOOST_REQUIRE_EQUAL(loaded.size(), 12u);
+    boost::filesystem::remove(file);
+
+    hash_digest expected;
+    hash_digest hash;
+    BOOST_REQUIRE(instance.get_hash(expected, 11));
+    BOOST_REQUIRE(loaded.get_hash(hash, 11));
+    BOOST_REQUIRE(hash == expected);
+
+    size_t height;
+    BOOST_REQUIRE(loaded.get_height(height, expected));
+    BOOST_REQUIRE_EQUAL(height, 11u);
+
+    uint32_t median;
+    BOOST_REQUIRE(loaded.get_median_time_past(median, 11));
+    BOOST_REQUIRE_EQUAL(median, 1060u);
+
+    // The work is recomputed from bits.
+    BOOST_REQUIRE(loaded.get_work_above(0) == instance.get_work_above(0));
+}
+
+BOOST_AUTO_TEST_CASE(header_index__load__missing_file__false_empty)
+{
+    header_index instance;
+    push_headers(instance, 2);
+    BOOST_REQUIRE(!instance.load("header_index__load__missing_file__false_empty"));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,129 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(input_scheduler_tests)
+
+typedef std::vector<std::pair<size_t, uint32_t>> visited;
+
+static visited drain(input_scheduler& instance)
+{
+    visited result;
+    size_t first;
+    size_t last;
+
+    while (instance.next(first, last))
+    {
+        instance.visit(first, last, [&](size_t position, uint32_t input_index)
+        {
+            result.emplace_back(position, input_index);
+            return true;
+        });
+    }
+
+    return result;
+}
+
+// size
+
+BOOST_AUTO_TEST_CASE(input_scheduler__size__default__zero)
+{
+    input_scheduler instance;
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.transactions(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(input_scheduler__size__added__skips_empty_transactions)
+{
+    input_scheduler instance;
+    instance.add(1, 2);
+    instance.add(2, 0);
+    instance.add(3, 5);
+    BOOST_REQUIRE_EQUAL(instance.size(), 7u);
+    BOOST_REQUIRE_EQUAL(instance.transactions(), 2u);
+}
+
+// next
+
+BOOST_AUTO_TEST_CASE(input_scheduler__next__empty__false)
+{
+    input_scheduler instance;
+    instance.distribute(4);
+    size_t first;
+    size_t last;
+    BOOST_REQUIRE(!instance.next(first, last));
+}
+
+BOOST_AUTO_TEST_CASE(input_scheduler__next__cancelled__false)
+{
+    input_scheduler instance;
+    instance.add(1, 100);
+    instance.distribute(4);
+    instance.cancel();
+    size_t first;
+    size_t last;
+    BOOST_REQUIRE(instance.cancelled());
+    BOOST_REQUIRE(!instance.next(first, last));
+}
+
+// visit
+
+BOOST_AUTO_TEST_CASE(input_scheduler__visit__all_chunks__each_input_once_in_order)
+{
+    input_scheduler instance;
+    instance.add(1, 3);
+    instance.add(4, 1000);
+    instance.add(7, 2);
+    instance.distribute(4);
+
+    const auto result = drain(instance);
+    BOOST_REQUIRE_EQUAL(result.size(), 1005u);
+    BOOST_REQUIRE(result[0] == std::make_pair(size_t(1), uint32_t(0)));
+    BOOST_REQUIRE(result[2] == std::make_pair(size_t(1), uint32_t(2)));
+    BOOST_REQUIRE(result[3] == std::make_pair(size_t(4), uint32_t(0)));
+    BOOST_REQUIRE(result[1002] == std::make_pair(size_t(4), uint32_t(999)));
+    BOOST_REQUIRE(result[1004] == std::make_pair(size_t(7), uint32_t(1)));
+}
+
+BOOST_AUTO_TEST_CASE(input_scheduler__visit__handler_false__stops)
+{
+    input_scheduler instance;
+    instance.add(1, 10);
+    size_t calls = 0;
+
+    const auto result = instance.visit(0, 10, [&](size_t, uint32_t input_index)
+    {
+        ++calls;
+        return input_index != 4;
+    });
+
+    BOOST_REQUIRE(!result);
+    BOOST_REQUIRE_EQUAL(calls, 5u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
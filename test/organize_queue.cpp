@@ -0,0 +1,338 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <vector>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(organize_queue_tests)
+
+// Records the organized items in order, optionally held until released.
+class organizer_fixture
+{
+public:
+    organizer_fixture()
+      : release_(released_.get_future().share())
+    {
+    }
+
+    organize_queue::block_function block_function(bool hold = false)
+    {
+        return [this, hold](block_const_ptr block, organize_queue::result_handler handler)
+        {
+            if (hold)
+                release_.wait();
+
+            order.push_back(block);
+            handler(error::success);
+        };
+    }
+
+    // Fails the check of the given block, records the checked count.
+    organize_queue::block_function check_function(block_const_ptr invalid)
+    {
+        return [this, invalid](block_const_ptr block, organize_queue::result_handler handler)
+        {
+            ++checked;
+            handler(block == invalid ? error::invalid_proof_of_work : error::success);
+        };
+    }
+
+    organize_queue::transaction_function transaction_function()
+    {
+        return [this](transaction_const_ptr tx, organize_queue::result_handler handler)
+        {
+            order.push_back(tx);
+            handler(error::success);
+        };
+    }
+
+    void release()
+    {
+        released_.set_value();
+    }
+
+    std::vector<std::shared_ptr<const void>> order;
+    std::atomic<size_t> checked{ 0 };
+
+private:
+    std::promise<void> released_;
+    std::shared_future<void> release_;
+};
+
+static block_const_ptr make_queued_block(uint32_t id)
+{
+    return std::make_shared<const message::block>(message::block
+    {
+        chain::header{ id, null_hash, null_hash, 0, 0, 0 }, {}
+    });
+}
+
+static transaction_const_ptr make_queued_transaction(uint32_t locktime)
+{
+    return std::make_shared<const message::transaction>(
+        message::transaction{ 1, locktime, {}, {} });
+}
+
+static code organize_and_wait(organize_queue& instance, block_const_ptr block)
+{
+    std::promise<code> complete;
+    instance.organize(block, [&complete](const code& ec)
+    {
+        complete.set_value(ec);
+    });
+
+    return complete.get_future().get();
+}
+
+// organize
+
+BOOST_AUTO_TEST_CASE(organize_queue__organize__stopped__service_stopped)
+{
+    organizer_fixture fixture;
+    organize_queue instance(4, 4, nullptr, fixture.block_function(),
+        fixture.transaction_function());
+    BOOST_REQUIRE_EQUAL(organize_and_wait(instance, make_queued_block(1)),
+        error::service_stopped);
+    BOOST_REQUIRE(fixture.order.empty());
+}
+
+BOOST_AUTO_TEST_CASE(organize_queue__organize__zero_capacity__organized_on_caller)
+{
+    organizer_fixture fixture;
+    organize_queue instance(0, 0, nullptr, fixture.block_function(),
+        fixture.transaction_function());
+    const auto block = make_queued_block(1);
+    BOOST_REQUIRE_EQUAL(organize_and_wait(instance, block), error::success);
+    BOOST_REQUIRE_EQUAL(fixture.order.size(), 1u);
+    BOOST_REQUIRE(fixture.order.front() == block);
+}
+
+BOOST_AUTO_TEST_CASE(organize_queue__organize__started__completes)
+{
+    organizer_fixture fixture;
+    organize_queue instance(4, 4, nullptr, fixture.block_function(),
+        fixture.transaction_function());
+    BOOST_REQUIRE(instance.start());
+    BOOST_REQUIRE_EQUAL(organize_and_wait(instance, make_queued_block(1)),
+        error::success);
+    BOOST_REQUIRE(instance.stop());
+
+    const auto metrics = instance.get_metrics();
+    BOOST_REQUIRE_EQUAL(metrics.organized_blocks, 1u);
+    BOOST_REQUIRE_EQUAL(metrics.queued_blocks, 0u);
+    BOOST_REQUIRE_EQUAL(metrics.peak_blocks, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(organize_queue__organize__queued__blocks_before_transactions)
+{
+    organizer_fixture fixture;
+    organize_queue instance(4, 4, nullptr, fixture.block_function(true),
+        fixture.transaction_function());
+    BOOST_REQUIRE(instance.start());
+
+    // The first block holds the drain task while the others queue.
+    const auto block1 = make_queued_block(1);
+    const auto block2 = make_queued_block(2);
+    const auto tx = make_queued_transaction(1);
+    std::promise<void> done;
+    instance.organize(block1, [](const code&) {});
+    instance.organize(tx, [&done](const code&) { done.set_value(); });
+    instance.organize(block2, [](const code&) {});
+    fixture.release();
+    done.get_future().wait();
+    BOOST_REQUIRE(instance.stop());
+
+    BOOST_REQUIRE_EQUAL(fixture.order.size(), 3u);
+    BOOST_REQUIRE(fixture.order[0] == block1);
+    BOOST_REQUIRE(fixture.order[1] == block2);
+    BOOST_REQUIRE(fixture.order[2] == tx);
+}
+
+BOOST_AUTO_TEST_CASE(organize_queue__organize__check_failed__not_organized)
+{
+    organizer_fixture fixture;
+    const auto invalid = make_queued_block(2);
+    organize_queue instance(4, 4, fixture.check_function(invalid),
+        fixture.block_function(), fixture.transaction_function());
+    BOOST_REQUIRE(instance.start());
+    BOOST_REQUIRE_EQUAL(organize_and_wait(instance, make_queued_block(1)),
+        error::success);
+    BOOST_REQUIRE_EQUAL(organize_and_wait(instance, invalid),
+        error::invalid_proof_of_work);
+    BOOST_REQUIRE(instance.stop());
+    BOOST_REQUIRE_EQUAL(fixture.checked, 2u);
+    BOOST_REQUIRE_EQUAL(fixture.order.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(organize_queue__organize__queued__checked_ahead)
+{
+    organizer_fixture fixture;
+    organize_queue instance(4, 4, fixture.check_function(nullptr),
+        fixture.block_function(true), fixture.transaction_function());
+    BOOST_REQUIRE(instance.start());
+
+    // The blocks queued behind the held one are checked on arrival.
+    std::promise<void> done;
+    instance.organize(make_queued_block(1), [](const code&) {});
+    instance.organize(make_queued_block(2), [](const code&) {});
+    instance.organize(make_queued_block(3), [&done](const code&) { done.set_value(); });
+    BOOST_REQUIRE_EQUAL(fixture.checked, 3u);
+    BOOST_REQUIRE(fixture.order.empty());
+
+    fixture.release();
+    done.get_future().wait();
+    BOOST_REQUIRE(instance.stop());
+    BOOST_REQUIRE_EQUAL(fixture.order.size(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE(organize_queue__organize__zero_capacity_check_failed__not_organized)
+{
+    organizer_fixture fixture;
+    const auto invalid = make_queued_block(1);
+    organize_queue instance(0, 0, fixture.check_function(invalid),
+        fixture.block_function(), fixture.transaction_function());
+    BOOST_REQUIRE_EQUAL(organize_and_wait(instance, invalid),
+        error::invalid_proof_of_work);
+    BOOST_REQUIRE(fixture.order.empty());
+}
+
+BOOST_AUTO_TEST_CASE(organize_queue__organize__full__waits_saturated)
+{
+    organizer_fixture fixture;
+    organize_queue instance(1, 4, nullptr, fixture.block_function(true),
+        fixture.transaction_function());
+
+    std::vector<bool> signals;
+    instance.set_backpressure_handler([&signals](bool saturated)
+    {
+        signals.push_back(saturated);
+    });
+
+    BOOST_REQUIRE(instance.start());
+
+    // The first block is taken by the drain task, the second is queued
+    // (filling the queue) once the first is held.
+    instance.organize(make_queued_block(1), [](const code&) {});
+
+    while (instance.get_metrics().queued_blocks != 0);
+
+    instance.organize(make_queued_block(2), [](const code&) {});
+    BOOST_REQUIRE(instance.saturated());
+
+    // The third waits for room instead of failing.
+    auto third = std::async(std::launch::async, [&instance]()
+    {
+        return organize_and_wait(instance, make_queued_block(3));
+    });
+
+    while (instance.get_metrics().throttled_blocks != 1);
+
+    fixture.release();
+    BOOST_REQUIRE_EQUAL(third.get(), error::success);
+    BOOST_REQUIRE(instance.stop());
+
+    const auto metrics = instance.get_metrics();
+    BOOST_REQUIRE_EQUAL(metrics.organized_blocks, 3u);
+    BOOST_REQUIRE_EQUAL(fixture.order.size(), 3u);
+    BOOST_REQUIRE(!instance.saturated());
+
+    // Signals alternate, starting saturated and ending drained.
+    BOOST_REQUIRE(!signals.empty());
+    BOOST_REQUIRE(signals.front());
+    BOOST_REQUIRE(!signals.back());
+
+    for (size_t index = 1; index < signals.size(); ++index)
+        BOOST_REQUIRE(signals[index] != signals[index - 1]);
+}
+
+BOOST_AUTO_TEST_CASE(organize_queue__stop__waiting__service_stopped)
+{
+    organizer_fixture fixture;
+    organize_queue instance(1, 4, nullptr, fixture.block_function(true),
+        fixture.transaction_function());
+    BOOST_REQUIRE(instance.start());
+
+    instance.organize(make_queued_block(1), [](const code&) {});
+
+    while (instance.get_metrics().queued_blocks != 0);
+
+    code queued;
+    instance.organize(make_queued_block(2), [&queued](const code& ec)
+    {
+        queued = ec;
+    });
+
+    auto waiting = std::async(std::launch::async, [&instance]()
+    {
+        return organize_and_wait(instance, make_queued_block(3));
+    });
+
+    while (instance.get_metrics().throttled_blocks != 1);
+
+    auto stopped = std::async(std::launch::async, [&instance]()
+    {
+        return instance.stop();
+    });
+
+    BOOST_REQUIRE_EQUAL(waiting.get(), error::service_stopped);
+    fixture.release();
+    BOOST_REQUIRE(stopped.get());
+    BOOST_REQUIRE_EQUAL(queued, error::service_stopped);
+    BOOST_REQUIRE_EQUAL(fixture.order.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(organize_queue__stop__queued__service_stopped)
+{
+    organizer_fixture fixture;
+    organize_queue instance(4, 4, nullptr, fixture.block_function(true),
+        fixture.transaction_function());
+    BOOST_REQUIRE(instance.start());
+
+    instance.organize(make_queued_block(1), [](const code&) {});
+
+    while (instance.get_metrics().queued_blocks != 0);
+
+    code result;
+    instance.organize(make_queued_transaction(1), [&result](const code& ec)
+    {
+        result = ec;
+    });
+
+    // Stop takes the queued transaction, then waits on the held block.
+    auto stopped = std::async(std::launch::async, [&instance]()
+    {
+        return instance.stop();
+    });
+
+    while (instance.get_metrics().queued_transactions != 0);
+
+    fixture.release();
+    BOOST_REQUIRE(stopped.get());
+    BOOST_REQUIRE_EQUAL(result, error::service_stopped);
+    BOOST_REQUIRE_EQUAL(fixture.order.size(), 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
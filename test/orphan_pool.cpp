@@ -0,0 +1,218 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(orphan_pool_tests)
+
+static block_const_ptr make_orphan(uint32_t id, const hash_digest& parent)
+{
+    return std::make_shared<const message::block>(message::block
+    {
+        chain::header{ id, parent, null_hash, 0, 0, 0 }, {}
+    });
+}
+
+static size_t block_size()
+{
+    return make_orphan(0, null_hash)->serialized_size(
+        message::version::level::canonical);
+}
+
+// construct
+
+BOOST_AUTO_TEST_CASE(orphan_pool__construct__zero__disabled)
+{
+    orphan_pool instance(0, 10);
+    BOOST_REQUIRE(!instance.enabled());
+    BOOST_REQUIRE(!instance.add(make_orphan(1, null_hash)));
+    BOOST_REQUIRE_EQUAL(instance.count(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(orphan_pool__construct__nonzero__enabled_empty)
+{
+    orphan_pool instance(42, 10);
+    BOOST_REQUIRE(instance.enabled());
+    BOOST_REQUIRE_EQUAL(instance.maximum_size(), 42u);
+    BOOST_REQUIRE_EQUAL(instance.maximum_count(), 10u);
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.count(), 0u);
+}
+
+// add
+
+BOOST_AUTO_TEST_CASE(orphan_pool__add__new__exists)
+{
+    orphan_pool instance(10 * block_size(), 10);
+    const auto block = make_orphan(1, null_hash);
+    BOOST_REQUIRE(instance.add(block));
+    BOOST_REQUIRE(instance.exists(block->hash()));
+    BOOST_REQUIRE_EQUAL(instance.size(), block_size());
+    BOOST_REQUIRE_EQUAL(instance.count(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(orphan_pool__add__duplicate__false)
+{
+    orphan_pool instance(10 * block_size(), 10);
+    const auto block = make_orphan(1, null_hash);
+    BOOST_REQUIRE(instance.add(block));
+    BOOST_REQUIRE(!instance.add(block));
+    BOOST_REQUIRE_EQUAL(instance.count(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(orphan_pool__add__larger_than_pool__false)
+{
+    orphan_pool instance(block_size() - 1, 10);
+    BOOST_REQUIRE(!instance.add(make_orphan(1, null_hash)));
+    BOOST_REQUIRE_EQUAL(instance.count(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(orphan_pool__add__over_count__evicts_oldest)
+{
+    orphan_pool instance(10 * block_size(), 2);
+    const auto block1 = make_orphan(1, null_hash);
+    const auto block2 = make_orphan(2, null_hash);
+    const auto block3 = make_orphan(3, null_hash);
+    instance.add(block1);
+    instance.add(block2);
+    instance.add(block3);
+    BOOST_REQUIRE(!instance.exists(block1->hash()));
+    BOOST_REQUIRE(instance.exists(block2->hash()));
+    BOOST_REQUIRE(instance.exists(block3->hash()));
+    BOOST_REQUIRE_EQUAL(instance.count(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(orphan_pool__add__over_size__evicts_oldest)
+{
+    orphan_pool instance(2 * block_size(), 10);
+    const auto block1 = make_orphan(1, null_hash);
+    const auto block2 = make_orphan(2, null_hash);
+    const auto block3 = make_orphan(3, null_hash);
+    instance.add(block1);
+    instance.add(block2);
+    instance.add(block3);
+    BOOST_REQUIRE(!instance.exists(block1->hash()));
+    BOOST_REQUIRE_EQUAL(instance.size(), 2 * block_size());
+}
+
+// remove_children
+
+BOOST_AUTO_TEST_CASE(orphan_pool__remove_children__unknown_parent__empty)
+{
+    orphan_pool instance(10 * block_size(), 10);
+    instance.add(make_orphan(1, null_hash));
+    BOOST_REQUIRE(instance.remove_children(hash_literal(
+        "4a5e1e4baab89f3a32518a88c31bc87f618f76673e2cc77ab2127b7afdeda33b")).empty());
+    BOOST_REQUIRE_EQUAL(instance.count(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(orphan_pool__remove_children__siblings__arrival_order)
+{
+    orphan_pool instance(10 * block_size(), 10);
+    const auto parent = make_orphan(1, null_hash);
+    const auto child1 = make_orphan(2, parent->hash());
+    const auto other = make_orphan(3, null_hash);
+    const auto child2 = make_orphan(4, parent->hash());
+    const auto child3 = make_orphan(5, parent->hash());
+    instance.add(child1);
+    instance.add(other);
+    instance.add(child2);
+    instance.add(child3);
+
+    const auto children = instance.remove_children(parent->hash());
+    BOOST_REQUIRE_EQUAL(children.size(), 3u);
+    BOOST_REQUIRE(children[0] == child1);
+    BOOST_REQUIRE(children[1] == child2);
+    BOOST_REQUIRE(children[2] == child3);
+    BOOST_REQUIRE(!instance.exists(child1->hash()));
+    BOOST_REQUIRE(instance.exists(other->hash()));
+    BOOST_REQUIRE_EQUAL(instance.count(), 1u);
+    BOOST_REQUIRE_EQUAL(instance.size(), block_size());
+}
+
+BOOST_AUTO_TEST_CASE(orphan_pool__remove_children__chain__one_generation)
+{
+    orphan_pool instance(10 * block_size(), 10);
+    const auto parent = make_orphan(1, null_hash);
+    const auto child = make_orphan(2, parent->hash());
+    const auto grandchild = make_orphan(3, child->hash());
+    instance.add(grandchild);
+    instance.add(child);
+
+    const auto children = instance.remove_children(parent->hash());
+    BOOST_REQUIRE_EQUAL(children.size(), 1u);
+    BOOST_REQUIRE(children.front() == child);
+
+    const auto grandchildren = instance.remove_children(child->hash());
+    BOOST_REQUIRE_EQUAL(grandchildren.size(), 1u);
+    BOOST_REQUIRE(grandchildren.front() == grandchild);
+    BOOST_REQUIRE_EQUAL(instance.count(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(orphan_pool__remove_children__after_eviction__not_returned)
+{
+    orphan_pool instance(10 * block_size(), 1);
+    const auto parent = make_orphan(1, null_hash);
+    instance.add(make_orphan(2, parent->hash()));
+    instance.add(make_orphan(3, null_hash));
+    BOOST_REQUIRE(instance.remove_children(parent->hash()).empty());
+}
+
+// filter
+
+BOOST_AUTO_TEST_CASE(orphan_pool__filter__pooled__removed)
+{
+    orphan_pool instance(10 * block_size(), 10);
+    const auto block1 = make_orphan(1, null_hash);
+    const auto block2 = make_orphan(2, null_hash);
+    instance.add(block1);
+
+    const message::inventory_vector expected1{ message::inventory::type_id::transaction, block1->hash() };
+    const message::inventory_vector expected2{ message::inventory::type_id::block, block2->hash() };
+    message::get_data data
+    {
+        { message::inventory::type_id::block, block1->hash() },
+        expected1,
+        expected2
+    };
+    const auto request = std::make_shared<message::get_data>(std::move(data));
+    instance.filter(request);
+    BOOST_REQUIRE_EQUAL(request->inventories().size(), 2u);
+    BOOST_REQUIRE(request->inventories()[0] == expected1);
+    BOOST_REQUIRE(request->inventories()[1] == expected2);
+}
+
+// clear
+
+BOOST_AUTO_TEST_CASE(orphan_pool__clear__populated__empty)
+{
+    orphan_pool instance(10 * block_size(), 10);
+    instance.add(make_orphan(1, null_hash));
+    instance.add(make_orphan(2, null_hash));
+    instance.clear();
+    BOOST_REQUIRE_EQUAL(instance.count(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(script_cache_tests)
+
+static const hash_digest hash1 = hash_literal("4a5e1e4baab89f3a32518a88c31bc87f618f76673e2cc77ab2127b7afdeda33b");
+static const hash_digest hash2 = hash_literal("3ba3edfd7a7b12b27ac72c3e67768f617fc81bc3888a51323a9fb8aa4b1e5e4a");
+
+// enabled
+
+BOOST_AUTO_TEST_CASE(script_cache__enabled__zero_capacity__false)
+{
+    script_cache instance(0);
+    BOOST_REQUIRE(!instance.enabled());
+}
+
+BOOST_AUTO_TEST_CASE(script_cache__add__zero_capacity__not_contained)
+{
+    script_cache instance(0);
+    instance.add(hash1, 0, 42);
+    BOOST_REQUIRE(!instance.contains(hash1, 0, 42));
+    BOOST_REQUIRE_EQUAL(instance.size(), 0u);
+}
+
+// contains
+
+BOOST_AUTO_TEST_CASE(script_cache__contains__empty__false_miss)
+{
+    script_cache instance(100);
+    BOOST_REQUIRE(!instance.contains(hash1, 0, 42));
+    BOOST_REQUIRE_EQUAL(instance.hits(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.misses(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(script_cache__contains__added__true_hit)
+{
+    script_cache instance(100);
+    instance.add(hash1, 1, 42);
+    BOOST_REQUIRE(instance.contains(hash1, 1, 42));
+    BOOST_REQUIRE_EQUAL(instance.hits(), 1u);
+    BOOST_REQUIRE_EQUAL(instance.misses(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(script_cache__contains__different_key__false)
+{
+    script_cache instance(100);
+    instance.add(hash1, 1, 42);
+    BOOST_REQUIRE(!instance.contains(hash2, 1, 42));
+    BOOST_REQUIRE(!instance.contains(hash1, 0, 42));
+    BOOST_REQUIRE(!instance.contains(hash1, 1, 43));
+    BOOST_REQUIRE_EQUAL(instance.misses(), 3u);
+}
+
+// add
+
+BOOST_AUTO_TEST_CASE(script_cache__add__duplicate__single_entry)
+{
+    script_cache instance(100);
+    instance.add(hash1, 0, 42);
+    instance.add(hash1, 0, 42);
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(script_cache__add__over_capacity__evicts_oldest)
+{
+    // Capacity is split in shards, a full shard evicts its oldest entry.
+    script_cache instance(16);
+
+    for (uint32_t index = 0; index < 100; ++index) {
+        instance.add(hash1, index, 42);
+    }
+
+    BOOST_REQUIRE(instance.size() <= instance.capacity());
+    BOOST_REQUIRE_EQUAL(instance.evictions(), 100u - instance.size());
+    BOOST_REQUIRE(!instance.contains(hash1, 0, 42));
+    BOOST_REQUIRE(instance.contains(hash1, 99, 42));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
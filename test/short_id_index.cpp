@@ -0,0 +1,162 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <vector>
+#include <bitcoin/blockchain.hpp>
+
+#ifdef BITPRIM_USE_DOMAIN
+#include <bitcoin/infrastructure/math/sip_hash.hpp>
+#else
+#include <bitcoin/bitcoin/math/sip_hash.hpp>
+#endif // BITPRIM_USE_DOMAIN
+
+using namespace bc;
+using namespace bc::blockchain;
+
+BOOST_AUTO_TEST_SUITE(short_id_index_tests)
+
+static const uint64_t k0 = 0x0706050403020100;
+static const uint64_t k1 = 0x0f0e0d0c0b0a0908;
+
+static hash_digest make_hash(uint32_t id)
+{
+    return bitcoin_hash(to_little_endian(id));
+}
+
+static uint64_t expected_short_id(hash_digest const& hash)
+{
+    return sip_hash_uint256(k0, k1, hash) & 0xffffffffffff;
+}
+
+// sip_hash
+
+BOOST_AUTO_TEST_CASE(short_id_index__sip_hash__partial_lanes__matches_scalar)
+{
+    // Not a multiple of the lanes, so the padded tail is covered.
+    const size_t count = 3 * short_id_index::lanes + 1;
+    hash_list hashes;
+
+    for (uint32_t id = 0; id < count; ++id)
+        hashes.push_back(make_hash(id));
+
+    std::vector<uint64_t> ids(count);
+    short_id_index::sip_hash(k0, k1, hashes.data(), count, ids.data());
+
+    for (size_t index = 0; index < count; ++index)
+        BOOST_REQUIRE_EQUAL(ids[index], expected_short_id(hashes[index]));
+}
+
+// short_ids
+
+BOOST_AUTO_TEST_CASE(short_id_index__short_ids__added__matches_scalar_and_txids)
+{
+    threadpool pool(2);
+    dispatcher dispatch(pool, "test");
+    short_id_index instance;
+
+    for (uint32_t id = 0; id < 100; ++id)
+        instance.add(make_hash(id), make_hash(id + 1000));
+
+    short_id_index::short_id_list ids;
+    hash_list txids;
+    instance.short_ids(k0, k1, dispatch, ids, txids);
+    pool.shutdown();
+    pool.join();
+
+    BOOST_REQUIRE_EQUAL(ids.size(), 100u);
+    BOOST_REQUIRE_EQUAL(txids.size(), 100u);
+
+    for (uint32_t id = 0; id < 100; ++id)
+    {
+        BOOST_REQUIRE_EQUAL(ids[id], expected_short_id(make_hash(id)));
+        BOOST_REQUIRE(txids[id] == make_hash(id + 1000));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(short_id_index__short_ids__buckets_with_remainder__all_hashed)
+{
+    // Above 4096 per thread, so each thread hashes a bucket, and the division
+    // leaves a remainder while the quotient is already a multiple of lanes.
+    const size_t threads = 3;
+    const size_t count = threads * 4100 + 2;
+    threadpool pool(threads);
+    dispatcher dispatch(pool, "test");
+    short_id_index instance;
+
+    for (uint32_t id = 0; id < count; ++id)
+        instance.add(make_hash(id), make_hash(id));
+
+    short_id_index::short_id_list ids;
+    hash_list txids;
+    instance.short_ids(k0, k1, dispatch, ids, txids);
+    pool.shutdown();
+    pool.join();
+
+    BOOST_REQUIRE_EQUAL(ids.size(), count);
+
+    for (uint32_t id = 0; id < count; ++id)
+        BOOST_REQUIRE_EQUAL(ids[id], expected_short_id(make_hash(id)));
+}
+
+// add/remove/reset
+
+BOOST_AUTO_TEST_CASE(short_id_index__add__duplicate_txid__ignored)
+{
+    short_id_index instance;
+    instance.add(make_hash(1), make_hash(1));
+    instance.add(make_hash(2), make_hash(1));
+    BOOST_REQUIRE_EQUAL(instance.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(short_id_index__remove__middle__keeps_pairs)
+{
+    threadpool pool(1);
+    dispatcher dispatch(pool, "test");
+    short_id_index instance;
+    instance.add(make_hash(1), make_hash(11));
+    instance.add(make_hash(2), make_hash(12));
+    instance.add(make_hash(3), make_hash(13));
+    instance.remove({ make_hash(12), make_hash(42) });
+
+    short_id_index::short_id_list ids;
+    hash_list txids;
+    instance.short_ids(k0, k1, dispatch, ids, txids);
+    pool.shutdown();
+    pool.join();
+
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+    BOOST_REQUIRE(txids[0] == make_hash(11));
+    BOOST_REQUIRE(txids[1] == make_hash(13));
+    BOOST_REQUIRE_EQUAL(ids[1], expected_short_id(make_hash(3)));
+}
+
+BOOST_AUTO_TEST_CASE(short_id_index__reset__replaces_content)
+{
+    short_id_index instance;
+    instance.add(make_hash(1), make_hash(1));
+    instance.reset({ make_hash(2), make_hash(3) }, { make_hash(2), make_hash(3) });
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+
+    instance.remove({ make_hash(1) });
+    BOOST_REQUIRE_EQUAL(instance.size(), 2u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
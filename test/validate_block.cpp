@@ -60,6 +60,33 @@ BOOST_AUTO_TEST_CASE(validate_block__native__block_438513_tx__valid) {
     BOOST_REQUIRE_EQUAL(result.value(), error::success);
 
 }
+
+BOOST_AUTO_TEST_CASE(validate_block__native__block_438513_tx_cached_data__valid) {
+    static const auto index = 0u;
+    static const auto forks = 62u;
+    static const auto encoded_script = "a914faa558780a5767f9e3be14992a578fc1cbcf483087";
+    static const auto encoded_tx = "0100000001a06bf74cc36eac395188b06850c5a01d00b355065c589d14036e89e075d7518e000000009d483045022100ba555ac17a084e2a1b621c2171fa563bc4fb75cd5c0968153f44ba7203cb876f022036626f4579de16e3ad160df01f649ffb8dbf47b504ee56dc3ad7260af24ca0db0101004c50632102768e47607c52e581595711e27faffa7cb646b4f481fe269bd49691b2fbc12106ad6704355e2658b1756821028a5af8284a12848d69a25a0ac5cea20be905848eb645fd03d3b065df88a9117cacfeffffff0158920100000000001976a9149d86f66406d316d44d58cbf90d71179dd8162dd388ac355e2658";
+
+    data_chunk decoded_tx;
+    BOOST_REQUIRE(decode_base16(decoded_tx, encoded_tx));
+
+    data_chunk decoded_script;
+    BOOST_REQUIRE(decode_base16(decoded_script, encoded_script));
+
+    transaction tx;
+    BOOST_REQUIRE(tx.from_data(decoded_tx));
+
+    auto& prevout = tx.inputs()[index].previous_output().validation.cache;
+    prevout.set_value(0);
+    prevout.set_script(script::factory_from_data(decoded_script, false));
+    BOOST_REQUIRE(prevout.script().is_valid());
+
+    auto const tx_data = validate_input::transaction_data(tx);
+    BOOST_REQUIRE(tx_data == decoded_tx);
+
+    auto const result = validate_input::verify_script(tx, tx_data, index, forks);
+    BOOST_REQUIRE_EQUAL(result.value(), error::success);
+}
 #ifdef BITPRIM_CURRENCY_BCH
 BOOST_AUTO_TEST_CASE(validate_block__native__block_520679_tx__valid)
 {
@@ -0,0 +1,125 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <thread>
+#include <bitcoin/blockchain.hpp>
+
+using namespace bc;
+using namespace bc::blockchain;
+
+// Built into bitprim_blockchain_benchmark, not registered with ctest:
+// bitprim_blockchain_benchmark --run_test=validate_block_benchmarks --log_level=message
+BOOST_AUTO_TEST_SUITE(validate_block_benchmarks)
+
+static const size_t benchmark_transactions = 20000;
+static const size_t benchmark_script_size = 400;
+static const size_t benchmark_iterations = 5;
+
+static chain::transaction make_transaction(uint32_t index)
+{
+    const auto previous_hash = bitcoin_hash(to_chunk(to_little_endian(index)));
+    const data_chunk script_data(benchmark_script_size, uint8_t(machine::opcode::push_positive_1));
+
+    chain::input::list inputs;
+    inputs.emplace_back(chain::output_point{ previous_hash, 0 }, chain::script{}, max_input_sequence);
+
+    chain::output::list outputs;
+    outputs.emplace_back(index, chain::script{ script_data, false });
+
+    return chain::transaction(1, 0, std::move(inputs), std::move(outputs));
+}
+
+static data_chunk make_block_data()
+{
+    chain::transaction::list txs;
+    txs.reserve(benchmark_transactions + 1);
+
+    chain::input::list inputs;
+    inputs.emplace_back(chain::output_point{ null_hash, chain::point::null_index }, chain::script{}, max_input_sequence);
+    chain::output::list outputs;
+    outputs.emplace_back(0, chain::script{});
+    txs.emplace_back(1, 0, std::move(inputs), std::move(outputs));
+
+    for (uint32_t index = 0; index < benchmark_transactions; ++index)
+        txs.push_back(make_transaction(index));
+
+    chain::block block(chain::header{}, std::move(txs));
+    block.header().set_merkle(block.generate_merkle_root());
+    return block.to_data();
+}
+
+BOOST_AUTO_TEST_CASE(validate_block__check__synthetic_block__throughput)
+{
+    threadpool pool(std::thread::hardware_concurrency());
+    dispatcher dispatch(pool, "validate_block_benchmark");
+    database::settings database_settings;
+    blockchain::settings chain_settings;
+    block_chain chain(pool, chain_settings, database_settings);
+    script_cache cache(0);
+
+#if defined(BITPRIM_WITH_MEMPOOL)
+    mining::mempool mempool;
+    validate_block validator(dispatch, chain, chain_settings, cache, false, mempool);
+#else
+    validate_block validator(dispatch, chain, chain_settings, cache, false);
+#endif
+
+    validator.start();
+    const auto data = make_block_data();
+    double total_seconds = 0;
+
+    for (size_t iteration = 0; iteration < benchmark_iterations; ++iteration)
+    {
+        // Deserialize each time so that no tx hash is cached.
+        chain::block instance;
+        BOOST_REQUIRE(instance.from_data(data));
+        const auto block = std::make_shared<const message::block>(std::move(instance));
+
+        std::promise<code> promise;
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        validator.check(block, [&promise](const code& ec)
+        {
+            promise.set_value(ec);
+        });
+
+        // The synthetic header has no valid proof of work, only time matters.
+        promise.get_future().wait();
+        const auto end = std::chrono::high_resolution_clock::now();
+        total_seconds += std::chrono::duration<double>(end - start).count();
+    }
+
+    const auto megabytes = double(data.size()) * benchmark_iterations / (1024 * 1024);
+
+    BOOST_TEST_MESSAGE("check: " << data.size() << " bytes, "
+        << benchmark_transactions << " txs, " << dispatch.size() << " threads, "
+        << (megabytes / total_seconds) << " MB/s");
+
+    validator.stop();
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
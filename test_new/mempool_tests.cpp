@@ -100,8 +100,8 @@ libbitcoin::chain::block get_block_from_template(mempool const& mp) {
     transaction::list tx_list;
     for (auto const& elem : gbt.first) {
         auto hash_index = mp.get_validated_txs_high();
-        auto it = hash_index.find(elem.txid());
-        tx_list.push_back((*it).second.second);
+        auto it = hash_index->find(elem.txid());
+        tx_list.push_back(*(*it).second);
     }
     return block({}, tx_list);
 }